@@ -1,11 +1,30 @@
 #ifndef AUTOMATON_H
 #define AUTOMATON_H
 
+#include <iosfwd>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
+class CSRAutomaton;
+
+/**
+ * @brief Partition-refinement strategy used by Automaton::minimize().
+ *
+ *   • Moore    – round-based signature refinement, O(n²·|Σ|) worst case.
+ *                Kept for reference and for its historical state numbering.
+ *   • Hopcroft – splitter worklist with the "smaller half" rule,
+ *                O(n·|Σ|·log n).
+ *   • ValmariLehtinen – refinement of states and transitions ("cords")
+ *                directly on a partial DFA, O(m·log n) for m defined
+ *                transitions; no sink completion is needed.  The result
+ *                is also trimmed (unreachable and dead states removed).
+ */
+enum class MinimizationAlgorithm { Moore, Hopcroft, ValmariLehtinen };
+
 /**
  * @class Automaton
  *
@@ -34,6 +53,10 @@
  *   - Reversal of transitions (transpose automaton)
  *   - Structural isomorphism checking
  *
+ * For traversal-heavy algorithms the map can be frozen once into an
+ * immutable CSRAutomaton (see freeze()), which is cached until the next
+ * mutation.
+ *
  * This class serves as the backbone of the entire project—
  * all higher-level algorithms (regex conversion, ENFA, NFA, DFA, minimal DFA,
  * Brzozowski’s algorithm, standardization, etc.) rely on this API.
@@ -60,16 +83,63 @@ public:
      */
     static Automaton readAutomaton(const std::string& filename);
 
+    /// Same format, read from a stream (e.g. text received over a socket).
+    static Automaton readAutomaton(std::istream& in);
+
+    /// A malformed line found by parseAutomaton().
+    struct ParseError {
+        size_t line;            ///< 1-based line number
+        std::string message;
+    };
+
+    /**
+     * @brief Parses the format of readAutomaton() from a buffer in memory.
+     *
+     * Malformed lines and tokens are skipped; each one is appended to
+     * errors (if given).  The readAutomaton() overloads report them on
+     * stderr.
+     *
+     * Large TRANSITIONS sections are split into newline-aligned chunks
+     * parsed by numThreads workers (0 = hardware concurrency).
+     */
+    static Automaton parseAutomaton(std::string_view text,
+                                    std::vector<ParseError>* errors = nullptr,
+                                    unsigned numThreads = 0);
+
     /**
      * @brief Performs classic **subset construction** to convert an NFA/ε-NFA
      *        into an equivalent DFA.
      *
      * Produces a deterministic automaton but not necessarily minimal.
+     * ε-transitions ('#') are followed while building the subsets, so an
+     * ε-NFA goes straight to a DFA without eNFAtoNFA().
      *
-     * @param A Input NFA.
+     * @param A        Input NFA or ε-NFA.
+     * @param complete If true (default) a dead sink state is added so that
+     *                 δ is total; if false the DFA is left partial, which is
+     *                 what MinimizationAlgorithm::ValmariLehtinen expects.
      * @return Deterministic automaton (DFA).
      */
-    static Automaton determinise(const Automaton& A);
+    static Automaton determinise(const Automaton& A, bool complete = true);
+
+    /**
+     * @brief Subset construction with each BFS level expanded by a pool
+     *        of worker threads.
+     *
+     * New subsets are interned in a sharded concurrent table.  With
+     * canonicalNumbering (default) the states are renumbered afterwards so
+     * the result is identical to determinise(A, complete); without it the
+     * numbering depends on thread timing.
+     *
+     * @param A                  Input NFA.
+     * @param numThreads         Worker threads; 0 = hardware concurrency.
+     * @param complete           Whether to add the dead sink state.
+     * @param canonicalNumbering Match the sequential state numbering.
+     * @return Deterministic automaton (DFA).
+     */
+    static Automaton determiniseParallel(const Automaton& A, unsigned numThreads = 0,
+                                         bool complete = true,
+                                         bool canonicalNumbering = true);
 
     /**
      * @brief Computes the **reverse (transpose) automaton** Aᵗ.
@@ -83,15 +153,16 @@ public:
     static Automaton reverseTransitions(const Automaton& A);
 
     /**
-     * @brief Minimizes a DFA using classical partition-refinement
-     *        (e.g. Moore or Hopcroft algorithm depending on implementation).
+     * @brief Minimizes a DFA using classical partition-refinement.
      *
      * Assumes the input is already deterministic.
      *
-     * @param A Deterministic automaton.
+     * @param A         Deterministic automaton.
+     * @param algorithm Refinement strategy (Hopcroft by default).
      * @return Minimal DFA equivalent to A.
      */
-    static Automaton minimize(const Automaton& A);
+    static Automaton minimize(const Automaton& A,
+                              MinimizationAlgorithm algorithm = MinimizationAlgorithm::Hopcroft);
 
     /**
      * @brief Checks structural **isomorphism** between two minimal DFAs.
@@ -122,8 +193,12 @@ public:
      *        format used throughout the project.
      *
      * @param filename Output path.
+     * @return False if the file could not be opened or written.
      */
-    void writeAutomaton(const std::string& filename) const;
+    bool writeAutomaton(const std::string& filename) const;
+
+    /// Same format, written to a stream.
+    void writeAutomaton(std::ostream& out) const;
 
 
     /* =====================================================================
@@ -150,6 +225,15 @@ public:
         return transitions; 
     }
 
+    /**
+     * @brief Returns the compressed-sparse-row form of this automaton.
+     *
+     * Built on first use and cached; any mutator drops the cache.  Safe to
+     * call concurrently on a const Automaton: at worst two threads build it
+     * at the same time, and both get the copy that was published first.
+     */
+    const CSRAutomaton& freeze() const;
+
 
     /* =====================================================================
        Mutators (Incremental Construction)
@@ -158,16 +242,19 @@ public:
     /// Add a state to the automaton.
     void addState(int s) {
         states.insert(s);
+        frozen.reset();
     }
 
     /// Add an initial state.
     void addInitialState(int s) {
         initialStates.insert(s);
+        frozen.reset();
     }
 
     /// Add a final (accepting) state.
     void addFinalState(int s) {
         finalStates.insert(s);
+        frozen.reset();
     }
 
     /**
@@ -180,20 +267,29 @@ public:
         transitions[{from, symbol}].insert(to);
         if (symbol != '#')
             alphabet.insert(symbol);
+        frozen.reset();
     }
 
     /// Set the entire alphabet explicitly.
     void setAlphabet(const std::set<char>& a) {
         alphabet = a;
+        frozen.reset();
     }
 
     /// Removes all transitions.
     void clearTransitions() {
         transitions.clear();
+        frozen.reset();
     }
 
 
 private:
+    /// Valmari–Lehtinen minimization (minimizePartial.cpp).
+    static Automaton minimizePartial(const Automaton& A);
+
+    friend class DenseDFA;
+    friend class CSRAutomaton;
+
     /* =====================================================================
        INTERNAL REPRESENTATION
     ===================================================================== */
@@ -210,6 +306,9 @@ private:
      * Supports both deterministic and nondeterministic automata.
      */
     std::map<std::pair<int, char>, std::set<int>> transitions;
+
+    /// Cached CSR form (see freeze()); null until first use.
+    mutable std::shared_ptr<const CSRAutomaton> frozen;
 };
 
 #endif
@@ -0,0 +1,214 @@
+#ifndef AUTOMATON_VIEW_H
+#define AUTOMATON_VIEW_H
+
+#include "Automaton.h"
+#include "CSRAutomaton.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @class AutomatonView
+ *
+ * @brief Read-only, zero-copy view of an automaton stored in the binary
+ *        format (".mtpa"), usually memory-mapped from a file.
+ *
+ * @details
+ * The binary format is the CSRAutomaton layout written out as is, so
+ * opening a file parses nothing: the view only checks the header and
+ * points into the mapping.  Little-endian, native alignment:
+ *
+ *     header (64 bytes)   magic "MTPA", byte-order tag, version, counts,
+ *                         total size
+ *     stateIds            int32  [n]        compact → original id
+ *     alphabet            char   [|Σ|]      declared alphabet
+ *     symbols             char   [k]        columns (no '#'), sorted
+ *     rowOffsets          uint32 [n+1]      edges of each state
+ *     edgeColumns         uint8  [m]        column of each edge
+ *     targetOffsets       uint32 [m+1]      targets of each edge
+ *     targets             uint32 [T]
+ *     epsOffsets          uint32 [n+1]      ε-targets of each state
+ *     epsTargets          uint32 [E]
+ *     initialBits         uint64 [⌈n/64⌉]
+ *     finalBits           uint64 [⌈n/64⌉]
+ *
+ * Every section starts on an 8-byte boundary.  The accessors have the
+ * names and meaning of CSRAutomaton's, and none of them allocates.
+ *
+ * open() checks the header and section sizes in O(1); verify() checks
+ * every offset and target (O(size)) for files that may be corrupt.
+ */
+class AutomatonView {
+public:
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t VERSION = 1;
+
+    AutomatonView() = default;
+    ~AutomatonView();
+
+    AutomatonView(const AutomatonView&) = delete;
+    AutomatonView& operator=(const AutomatonView&) = delete;
+
+    AutomatonView(AutomatonView&& other) noexcept;
+    AutomatonView& operator=(AutomatonView&& other) noexcept;
+
+    /**
+     * @brief Maps a binary automaton file read-only.
+     *
+     * @return False if the file cannot be mapped or is not a valid image;
+     *         error() then says why.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Views an image already in memory (not copied, not owned).
+     *
+     * data must be 8-byte aligned and outlive the view.
+     */
+    bool attach(const void* data, size_t size);
+
+    /// Deep consistency check of every offset, column, symbol and target.
+    bool verify() const;
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    const std::string& error() const {
+        return lastError;
+    }
+
+    /**
+     * @brief Writes C in the binary format.
+     *
+     * @return False if the file cannot be written.
+     */
+    static bool write(const CSRAutomaton& C, const std::string& path);
+
+    /// Copies the view into an owning CSRAutomaton.
+    CSRAutomaton toCSR() const;
+
+
+    /* =====================================================================
+       Queries (as in CSRAutomaton)
+    ===================================================================== */
+
+    uint32_t size() const {
+        return n;
+    }
+
+    int stateId(uint32_t q) const {
+        return stateIds[q];
+    }
+
+    bool isInitial(uint32_t q) const {
+        return (initialBits[q >> 6] >> (q & 63)) & 1;
+    }
+
+    bool isFinal(uint32_t q) const {
+        return (finalBits[q >> 6] >> (q & 63)) & 1;
+    }
+
+    std::string_view getSymbols() const {
+        return { symbols, k };
+    }
+
+    std::string_view getAlphabet() const {
+        return { alphabet, alphabetLength };
+    }
+
+    uint32_t alphabetSize() const {
+        return k;
+    }
+
+    int column(char c) const {
+        return columnOf[(unsigned char)c];
+    }
+
+    uint32_t edgeBegin(uint32_t q) const {
+        return rowOffsets[q];
+    }
+
+    uint32_t edgeEnd(uint32_t q) const {
+        return rowOffsets[q + 1];
+    }
+
+    uint32_t numEdges() const {
+        return m;
+    }
+
+    uint32_t edgeColumn(uint32_t e) const {
+        return edgeColumns[e];
+    }
+
+    const uint32_t* targetsBegin(uint32_t e) const {
+        return targets + targetOffsets[e];
+    }
+
+    const uint32_t* targetsEnd(uint32_t e) const {
+        return targets + targetOffsets[e + 1];
+    }
+
+    /// Edge of state q labelled with column col, or NONE (binary search).
+    uint32_t findEdge(uint32_t q, uint32_t col) const;
+
+    /// Targets of q on symbol c as [first, last); empty if there are none.
+    std::pair<const uint32_t*, const uint32_t*> successors(uint32_t q, char c) const;
+
+    const uint32_t* epsilonBegin(uint32_t q) const {
+        return epsTargets + epsOffsets[q];
+    }
+
+    const uint32_t* epsilonEnd(uint32_t q) const {
+        return epsTargets + epsOffsets[q + 1];
+    }
+
+    bool hasEpsilon() const {
+        return numEpsTargets != 0;
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    void* mapping = nullptr;        ///< Owned mmap region, if any
+    size_t mappingSize = 0;
+    std::string lastError;
+
+    uint32_t n = 0, m = 0, k = 0;
+    uint32_t numTargets = 0, numEpsTargets = 0, alphabetLength = 0;
+
+    const int32_t*  stateIds = nullptr;
+    const char*     alphabet = nullptr;
+    const char*     symbols = nullptr;
+    const uint32_t* rowOffsets = nullptr;
+    const uint8_t*  edgeColumns = nullptr;
+    const uint32_t* targetOffsets = nullptr;
+    const uint32_t* targets = nullptr;
+    const uint32_t* epsOffsets = nullptr;
+    const uint32_t* epsTargets = nullptr;
+    const uint64_t* initialBits = nullptr;
+    const uint64_t* finalBits = nullptr;
+    int16_t columnOf[256] = {};
+
+    bool fail(const std::string& why);
+    void release();
+};
+
+/**
+ * @brief Writes A in the binary format (through its frozen CSR form).
+ */
+bool writeBinaryAutomaton(const Automaton& A, const std::string& path);
+
+/**
+ * @brief Reads a binary automaton file into a map-based Automaton.
+ *
+ * Like Automaton::readAutomaton, returns an empty automaton if the file
+ * is missing or invalid.  The reason is stored in *error when error is
+ * given (and cleared on success), otherwise reported on stderr.
+ */
+Automaton readBinaryAutomaton(const std::string& path, std::string* error = nullptr);
+
+#endif
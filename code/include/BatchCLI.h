@@ -0,0 +1,50 @@
+#ifndef BATCH_CLI_H
+#define BATCH_CLI_H
+
+/**
+ * @brief Non-interactive entry point: runs one subcommand over many files.
+ *
+ * @details
+ * Usage:
+ *
+ *     mtp <command> [options] <file>...
+ *
+ * Commands (one output file per input, named after the input's stem):
+ *
+ *   - determinise     automaton → DFA                  dfa_<stem>.txt
+ *   - minimize        automaton → minimal DFA          min_<stem>.txt
+ *   - minimize-regex  regex (first line) → minimized   min_regex_<stem>.txt
+ *   - to-binary       text automaton → binary format   <stem>.mtpa
+ *   - to-text         binary automaton → text format   <stem>.txt
+ *
+ * Automaton inputs ending in ".mtpa" are read in the binary format
+ * (AutomatonView.h), all others as text.
+ *
+ * and, taking no files,
+ *
+ *   - serve           NDJSON request server (runDaemon, Daemon.h) on
+ *                     --socket=PATH, or on stdin/stdout without it;
+ *                     --cache=N and --cache-mb=N bound each of its warm
+ *                     caches by entries and by megabytes
+ *
+ * Options:
+ *
+ *   - --algo=moore|hopcroft|valmari        minimization (default hopcroft)
+ *   - --construction=thompson|glushkov|antimirov|derivatives
+ *                                          regex → automaton (default glushkov)
+ *   - --jobs=N                             worker threads, 0..1024 (default: all cores)
+ *   - --out=DIR                            output directory (default ../../outputs)
+ *
+ * Files are processed concurrently by a ThreadPool, each by one worker
+ * that also writes its result, so nothing is serialised but the error
+ * log.  A file fails if it cannot be read, has malformed lines, is a
+ * corrupt binary image, or its result cannot be written; inputs that
+ * would write the same output file are refused up front.  No DOT files or images are produced.  The menu of main() is not
+ * involved: nothing is read from stdin.
+ *
+ * @return Exit status: 0 if every file succeeded, 1 if some failed,
+ *         2 on a usage error.
+ */
+int runBatch(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef CSR_AUTOMATON_H
+#define CSR_AUTOMATON_H
+
+#include "Automaton.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class CSRAutomaton
+ *
+ * @brief Immutable compressed-sparse-row (CSR) form of a nondeterministic
+ *        automaton, built once from an Automaton by Automaton::freeze().
+ *
+ * @details
+ * States are compacted to 0 .. n-1 in increasing original-id order.
+ * Outgoing labelled transitions of state q are stored as a contiguous,
+ * symbol-sorted run of edges:
+ *
+ *     edges  [ rowOffsets[q] , rowOffsets[q+1] )
+ *
+ * where edge e carries one column symbol and a contiguous, sorted range of
+ * targets:
+ *
+ *     targets[ targetOffsets[e] , targetOffsets[e+1] )
+ *
+ * ε-transitions ('#') are kept apart in their own CSR arrays, so algorithms
+ * that ignore ε never see them and ε-closure never scans symbol edges.
+ *
+ * Only symbols that actually leave a state occupy space in its row, so
+ * sparse automata over large alphabets are visited in O(out-degree) rather
+ * than O(|Σ|) per state.
+ */
+class CSRAutomaton {
+public:
+
+    /// Sentinel for "no such state / column".
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    CSRAutomaton() {
+        indexSymbols();
+    }
+
+    /**
+     * @brief Builds the CSR form of A.
+     *
+     * Every state id mentioned anywhere in A (states, transitions, initial,
+     * final) becomes a compact state.  Columns are the non-'#' symbols of the
+     * declared alphabet and of the transitions, sorted.
+     */
+    static CSRAutomaton fromAutomaton(const Automaton& A);
+
+    /**
+     * @brief Converts back to the map-based representation, restoring the
+     *        original state ids and declared alphabet.
+     */
+    Automaton toAutomaton() const;
+
+    /**
+     * @brief Returns the transpose automaton: every edge (and ε-edge) is
+     *        reversed, and initial ↔ final states are swapped.
+     *
+     * Built with two counting-sort passes, O(n + |Σ| + m).
+     */
+    CSRAutomaton reverse() const;
+
+
+    /* =====================================================================
+       States
+    ===================================================================== */
+
+    uint32_t size() const {
+        return (uint32_t)stateIds.size();
+    }
+
+    /// Original Automaton id of compact state q.
+    int stateId(uint32_t q) const {
+        return stateIds[q];
+    }
+
+    /// Compact index of an original state id, or NONE.
+    uint32_t indexOf(int id) const;
+
+    /// Compact initial states, sorted.
+    const std::vector<uint32_t>& getInitialStates() const {
+        return initialStates;
+    }
+
+    bool isFinal(uint32_t q) const {
+        return finals[q] != 0;
+    }
+
+
+    /* =====================================================================
+       Symbols
+    ===================================================================== */
+
+    /// Column symbols (no '#'), sorted.
+    const std::string& getSymbols() const {
+        return symbols;
+    }
+
+    uint32_t alphabetSize() const {
+        return (uint32_t)symbols.size();
+    }
+
+    /// Declared alphabet Σ of the source automaton.
+    const std::string& getAlphabet() const {
+        return alphabet;
+    }
+
+    /// Column of symbol c, or -1.
+    int column(char c) const {
+        return columnOf[(unsigned char)c];
+    }
+
+
+    /* =====================================================================
+       Labelled edges
+    ===================================================================== */
+
+    uint32_t edgeBegin(uint32_t q) const {
+        return rowOffsets[q];
+    }
+
+    uint32_t edgeEnd(uint32_t q) const {
+        return rowOffsets[q + 1];
+    }
+
+    uint32_t numEdges() const {
+        return (uint32_t)edgeColumns.size();
+    }
+
+    /// Column of edge e.
+    uint32_t edgeColumn(uint32_t e) const {
+        return edgeColumns[e];
+    }
+
+    const uint32_t* targetsBegin(uint32_t e) const {
+        return targets.data() + targetOffsets[e];
+    }
+
+    const uint32_t* targetsEnd(uint32_t e) const {
+        return targets.data() + targetOffsets[e + 1];
+    }
+
+    /**
+     * @brief Edge of state q labelled with column col, or NONE.
+     *
+     * Binary search over q's (sorted) row.
+     */
+    uint32_t findEdge(uint32_t q, uint32_t col) const;
+
+
+    /* =====================================================================
+       ε-edges
+    ===================================================================== */
+
+    const uint32_t* epsilonBegin(uint32_t q) const {
+        return epsTargets.data() + epsOffsets[q];
+    }
+
+    const uint32_t* epsilonEnd(uint32_t q) const {
+        return epsTargets.data() + epsOffsets[q + 1];
+    }
+
+    bool hasEpsilon() const {
+        return !epsTargets.empty();
+    }
+
+private:
+    friend class AutomatonView;     // binary format = these arrays
+
+    std::vector<int> stateIds;          ///< Compact → original id (sorted)
+    std::string symbols;                ///< Column → symbol
+    std::string alphabet;               ///< Declared Σ
+    int columnOf[256];                  ///< Symbol → column, -1 if absent
+
+    std::vector<uint32_t> rowOffsets;   ///< n+1 offsets into edge arrays
+    std::vector<uint8_t>  edgeColumns;  ///< Column of each edge
+    std::vector<uint32_t> targetOffsets;///< edges+1 offsets into targets
+    std::vector<uint32_t> targets;      ///< Concatenated target ranges
+
+    std::vector<uint32_t> epsOffsets;   ///< n+1 offsets into epsTargets
+    std::vector<uint32_t> epsTargets;   ///< Concatenated ε-targets
+
+    std::vector<uint32_t> initialStates;
+    std::vector<uint8_t>  finals;
+
+    void indexSymbols();
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef DFA_MATCHER_H
+#define DFA_MATCHER_H
+
+#include "Automaton.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class DFAMatcher
+ *
+ * @brief Compiled scanner that runs a DFA over text.
+ *
+ * @details
+ * The DFA (complete or partial, e.g. the output of minimalDFA or
+ * regexToMinimalDFA) is compiled into a byte-driven table:
+ *
+ *   - byteClass[256]: input byte → equivalence class.  Bytes outside the
+ *     alphabet, and symbols whose columns are identical, share a class;
+ *   - table[ row + class ]: the next row, with row ids premultiplied by the
+ *     number of classes so a step is one load and one add;
+ *   - every state from which no final state is reachable (including the
+ *     sink added by Automaton::determinise) is collapsed into row 0, so a
+ *     scan stops as soon as it becomes 0;
+ *   - a final state that loops to itself on every byte ("accept the rest",
+ *     e.g. after `error` in Σ*errorΣ*) ends a scan early as well;
+ *   - findFirst() finds the leftmost match start in one backward pass
+ *     of a DFA for Σ*·reverse(L).  That DFA can be exponentially larger
+ *     than the forward one, so it is never built in full: its states are
+ *     made on demand, as in LazyDFA, in a cache of at most reverseBudget
+ *     bytes per thread, and nothing of it exists before the first
+ *     findFirst() call.  A scan that fills the cache falls back to
+ *     trying start positions one by one with the forward table.
+ *
+ * countMatchingLines() scans four independent stretches of lines
+ * interleaved in one loop, so the table loads of different lines overlap
+ * instead of forming one long dependency chain.
+ *
+ * All scans are const and may run concurrently on one matcher.  A
+ * matcher can be moved but not copied.
+ */
+class DFAMatcher {
+public:
+
+    /// Half-open byte range [begin, end) of a match.
+    struct Match {
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    /**
+     * @brief Compiles a deterministic Automaton.
+     *
+     * @param dfa           Complete or partial DFA.
+     * @param reverseBudget Bytes of reverse-search states cached per
+     *                      thread by findFirst().
+     */
+    explicit DFAMatcher(const Automaton& dfa, size_t reverseBudget = 8u << 20);
+
+    ~DFAMatcher();
+
+    DFAMatcher(DFAMatcher&&) noexcept;
+    DFAMatcher& operator=(DFAMatcher&&) noexcept;
+
+    /// True if the whole text is in the language.
+    bool accepts(std::string_view text) const;
+
+    /**
+     * @brief Leftmost-longest match anywhere in text.
+     *
+     * O(|text|) while the reverse-search cache suffices (see above),
+     * otherwise O(|text|²) in the worst case.
+     *
+     * @param text  Input.
+     * @param match Receives the match, if any.
+     * @return      True if some substring (possibly empty) matches.
+     */
+    bool findFirst(std::string_view text, Match& match) const;
+
+    /**
+     * @brief Number of lines of buffer that are, in full, in the language.
+     *
+     * Lines are separated by '\n', which is not part of the line.  A final
+     * segment without a trailing '\n' counts as a line if it is not empty.
+     */
+    size_t countMatchingLines(std::string_view buffer) const;
+
+    /// Number of live DFA states kept (excluding the dead row).
+    uint32_t numStates() const {
+        return numRows - 1;
+    }
+
+    /// Number of byte classes (class 0 always leads to the dead row).
+    uint32_t numClasses() const {
+        return classes;
+    }
+
+private:
+    uint16_t byteClass[256];
+    uint32_t classes = 1;
+    uint32_t numRows = 1;
+    uint32_t start = 0;             ///< Premultiplied start row (0 = dead)
+    uint32_t acceptAll = NO_ROW;    ///< Premultiplied accept-the-rest row
+
+    static constexpr uint32_t NO_ROW = UINT32_MAX;
+
+    std::vector<uint32_t> table;    ///< numRows × classes, premultiplied targets
+    std::vector<uint8_t> finals;    ///< Indexed by premultiplied row
+
+    /// Lazy reverse search of findFirst() (dfaMatcher.cpp).
+    class ReverseSearch;
+    std::unique_ptr<ReverseSearch> reverse;
+
+    bool isFinalRow(uint32_t row) const {
+        return finals[row] != 0;
+    }
+
+    /// True once the rest of the input cannot change the outcome.
+    bool isDecided(uint32_t row) const {
+        return row == 0 || row == acceptAll;
+    }
+
+    /// Row reached from `row` after reading text[from, to), stopping early
+    /// at the dead or accept-all row.
+    uint32_t run(uint32_t row, const unsigned char* from, const unsigned char* to) const;
+
+    /// Longest match starting at begin, or SIZE_MAX if there is none.
+    size_t longestEnd(const unsigned char* data, size_t len, size_t begin) const;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Settings of the long-running server mode.
+ */
+struct DaemonOptions {
+    std::string socketPath;     ///< Unix domain socket; empty = stdin/stdout
+    unsigned jobs = 0;          ///< Worker threads; 0 = all cores
+    size_t cacheEntries = 4096; ///< Entries per warm cache
+    size_t cacheBytes = size_t(256) << 20;  ///< Estimated bytes per warm cache
+};
+
+/**
+ * @brief Serves automaton and regex operations as newline-delimited JSON.
+ *
+ * @details
+ * Every request is one JSON object on one line; every response is one
+ * line too, carrying the request's "id" (any JSON value) back:
+ *
+ *     {"id": 1, "op": "minimize-regex", "regex": "(a|b)*abb"}
+ *     {"id":1,"ok":true,"result":"(a|b)*abb"}
+ *
+ * Operations ("op"):
+ *
+ *   - ping                          → "pong"
+ *   - determinise, minimize,
+ *     brzozowski                    → the resulting automaton, as text in
+ *                                     the format of writeAutomaton()
+ *   - isomorphic                    → true / false (inputs: minimal DFAs)
+ *   - standardize-regex,
+ *     minimize-regex                → a regex string
+ *   - stats                         → cache sizes, bytes, hits and misses
+ *
+ * Inputs: an automaton is given inline as "automaton" (file-format text)
+ * or as a "file" path (".mtpa" files in the binary format of
+ * AutomatonView.h); the second automaton of "isomorphic" as
+ * "automaton2" or "file2".  Regex operations take "regex".  Optional
+ * "algo" (moore | hopcroft | valmari) and "construction" (thompson |
+ * glushkov | antimirov | derivatives) select the algorithms.
+ *
+ * Failures produce {"id":…,"ok":false,"error":"…"}, including automata
+ * with malformed lines (the message names the first one) and unreadable
+ * or corrupt files.
+ *
+ * Requests run concurrently on a ThreadPool, so responses of one client
+ * may come back out of order; match them by id.  At most 64 requests of
+ * a client are in flight: further lines are read as responses are
+ * written, so a client that stops reading only stalls itself.  Request
+ * lines are limited to 64 MiB.
+ *
+ * Two warm LRU caches are shared by all clients: parsed automata (files
+ * are re-read when their size or modification time changes) and results
+ * of the regex operations.  Each is bounded by entry count and by an
+ * estimate of the bytes it holds; inline automata and regexes are keyed
+ * by a hash of their text, not the text itself.
+ *
+ * With a socket path the server accepts any number of clients until it
+ * is killed; without one it serves stdin/stdout and returns at EOF once
+ * all requests are answered.
+ *
+ * @return Exit status (non-zero if the socket cannot be set up).
+ */
+int runDaemon(const DaemonOptions& options);
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef DENSE_DFA_H
+#define DENSE_DFA_H
+
+#include "Automaton.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class DenseDFA
+ *
+ * @brief Flat, array-backed representation of a deterministic automaton.
+ *
+ * @details
+ * Where Automaton stores δ as a node-based map, a DenseDFA stores it as a
+ * single row-major table:
+ *
+ *     table[ state * |Σ| + column ]  =  δ(state, symbols[column])
+ *
+ * with states renumbered contiguously as 0 .. n-1.  Every transition lookup
+ * is therefore one array access, and an n-state DFA over Σ costs exactly
+ * n·|Σ|·4 bytes of transition storage.
+ *
+ * Missing transitions (partial DFAs) are stored as DenseDFA::NONE.
+ *
+ * The original Automaton state ids and the declared alphabet are kept, so
+ *
+ *     DenseDFA::fromAutomaton(A).toAutomaton()
+ *
+ * reproduces A exactly whenever A is deterministic.
+ *
+ * Used internally by minimization, isomorphism checking and determinisation
+ * for all DFA-side work.
+ */
+class DenseDFA {
+public:
+
+    /// Sentinel for "no transition" and "no initial state".
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    DenseDFA() : DenseDFA(0, "") {}
+
+    /**
+     * @brief Creates a DFA with @p numStates states and no transitions.
+     *
+     * @param numStates Number of states (ids 0 .. numStates-1).
+     * @param symbols   Column symbols, one per table column.
+     */
+    DenseDFA(uint32_t numStates, const std::string& symbols);
+
+
+    /* =====================================================================
+       Conversion to / from Automaton
+    ===================================================================== */
+
+    /**
+     * @brief Builds a dense table from a deterministic Automaton.
+     *
+     * States are compacted in increasing id order; columns are the declared
+     * alphabet plus any other symbol used by a transition, in sorted order.
+     *
+     * If A is not deterministic, an error is reported and the smallest
+     * target / initial state is kept (matching the `*set.begin()` behaviour
+     * of the map-based code).
+     */
+    static DenseDFA fromAutomaton(const Automaton& A);
+
+    /**
+     * @brief Converts back to the map-based Automaton representation,
+     *        using the stored original state ids.
+     */
+    Automaton toAutomaton() const;
+
+
+    /* =====================================================================
+       Queries
+    ===================================================================== */
+
+    uint32_t size() const {
+        return numStates;
+    }
+
+    uint32_t alphabetSize() const {
+        return (uint32_t)symbols.size();
+    }
+
+    /// Column symbols, in column order.
+    const std::string& getSymbols() const {
+        return symbols;
+    }
+
+    /// Declared alphabet Σ (restored by toAutomaton()).
+    const std::string& getAlphabet() const {
+        return alphabet;
+    }
+
+    /// Column of symbol c, or -1 if c is not a column.
+    int column(char c) const {
+        return columnOf[(unsigned char)c];
+    }
+
+    /// δ(state, symbols[col]), or NONE.
+    uint32_t next(uint32_t state, uint32_t col) const {
+        return table[(size_t)state * symbols.size() + col];
+    }
+
+    /// δ(state, c), or NONE if c is not in the alphabet or undefined.
+    uint32_t step(uint32_t state, char c) const {
+        int col = column(c);
+        return col < 0 ? NONE : next(state, (uint32_t)col);
+    }
+
+    uint32_t getInitial() const {
+        return initial;
+    }
+
+    bool isFinal(uint32_t state) const {
+        return finals[state] != 0;
+    }
+
+    /// Original Automaton id of a dense state.
+    int stateId(uint32_t state) const {
+        return stateIds[state];
+    }
+
+    /// True if no transition is NONE.
+    bool isComplete() const;
+
+    /// Raw row-major transition table.
+    const std::vector<uint32_t>& getTable() const {
+        return table;
+    }
+
+
+    /* =====================================================================
+       Mutators
+    ===================================================================== */
+
+    /// Appends a fresh state with no transitions; returns its index.
+    uint32_t addState();
+
+    void setNext(uint32_t state, uint32_t col, uint32_t target) {
+        table[(size_t)state * symbols.size() + col] = target;
+    }
+
+    void setInitial(uint32_t state) {
+        initial = state;
+    }
+
+    void setFinal(uint32_t state, bool isFinalState = true) {
+        finals[state] = isFinalState ? 1 : 0;
+    }
+
+    /// Overrides the declared alphabet (defaults to the non-'#' columns).
+    void setAlphabet(const std::string& a) {
+        alphabet = a;
+    }
+
+private:
+    uint32_t numStates = 0;
+
+    std::string symbols;        ///< Column → symbol
+    std::string alphabet;       ///< Declared Σ, sorted
+    int columnOf[256];          ///< Symbol → column, -1 if absent
+
+    std::vector<uint32_t> table;    ///< numStates × |symbols|, row-major
+    std::vector<uint8_t>  finals;   ///< finals[s] != 0 ⇔ s ∈ F
+    std::vector<int>      stateIds; ///< Dense index → original state id
+
+    uint32_t initial = NONE;
+
+    void indexSymbols();
+};
+
+#endif
@@ -6,6 +6,18 @@
 #include <map>
 #include <string>
 
+/**
+ * @brief Which files the pipeline stages (regexToENFA, eNFAtoNFA,
+ *        minimalDFA, proposition313, brozozowskisAlgorithm, ...) write
+ *        for each automaton they produce.
+ *
+ *   • None – nothing; results stay in memory.
+ *   • Text – the automaton text file only.
+ *   • Dot  – text file and DOT graph.
+ *   • Png  – text file, DOT graph and PNG image (default).
+ */
+enum class ArtifactPolicy { None, Text, Dot, Png };
+
 /**
  * @class Dot
  *
@@ -18,8 +30,11 @@
  *
  * It provides:
  *
- *   • generateDot() – Convert an automaton text file → DOT graph
- *   • generateImage() – Convert DOT graph → PNG using Graphviz command-line
+ *   • generateDot() – Convert an automaton (or its text file) → DOT graph
+ *   • generateImage() – Convert DOT graph → PNG using Graphviz command-line,
+ *       asynchronously (see RenderQueue)
+ *   • writeArtifacts() – Text file + DOT + PNG of one pipeline stage,
+ *       as far as the global ArtifactPolicy allows
  *   • generateIsomorphismDot() – Visualize two automata side-by-side
  *       with isomorphism mapping edges
  *
@@ -29,9 +44,8 @@
  * All DOT files are written to:
  *      ../../dots/
  *
- * This class does not interpret automata directly except in the isomorphism
- * visualization function — it generally converts already existing text
- * automaton descriptions into DOT syntax.
+ * DOT graphs are built from the in-memory Automaton; the file-based
+ * generateDot() only reads the file first.
  */
 class Dot {
 public:
@@ -59,12 +73,24 @@ public:
                      const std::string& outputFilename,
                      const std::string& graphName);
 
+    /**
+     * @brief Same DOT graph, built directly from an automaton in memory.
+     *
+     * @param A              Automaton to draw.
+     * @param outputFilename Path where DOT file should be written.
+     * @param graphName      Name of the DOT graph.
+     */
+    void generateDot(const Automaton& A,
+                     const std::string& outputFilename,
+                     const std::string& graphName);
+
     /**
      * @brief Converts a DOT file into a PNG image using Graphviz.
      *
      * @details
-     * Internally executes:
+     * Queues, on RenderQueue::shared(), a process running:
      *     dot -Tpng <dotfile> -o <outputfile>
+     * and returns without waiting for it.
      *
      * Images are stored in:
      *     ../../images/prefix + filename + ".png"
@@ -77,6 +103,42 @@ public:
                        const std::string& prefix,
                        const std::string& filename);
 
+    /**
+     * @brief Writes the files of one pipeline stage for automaton A, as
+     *        far as artifactPolicy() allows.
+     *
+     * @details
+     *     Text: A.writeAutomaton(textFile)        (skipped if textFile is empty)
+     *     Dot:  generateDot(A, dotFile, graphName)
+     *     Png:  generateImage(dotFile, prefix, filename)
+     *
+     * @param A         Automaton produced by the stage.
+     * @param textFile  Path of the text file, or "" for none (e.g. when A
+     *                  was read from that file).
+     * @param dotFile   Path of the DOT file.
+     * @param graphName Name of the DOT graph.
+     * @param prefix    Prefix of the image filename.
+     * @param filename  Base name of the image file.
+     */
+    void writeArtifacts(const Automaton& A,
+                        const std::string& textFile,
+                        const std::string& dotFile,
+                        const std::string& graphName,
+                        const std::string& prefix,
+                        const std::string& filename);
+
+    /// Sets the policy used by writeArtifacts() (process-wide).
+    static void setArtifactPolicy(ArtifactPolicy policy);
+
+    static ArtifactPolicy artifactPolicy();
+
+    /**
+     * @brief Parses "none", "text", "dot" or "png".
+     *
+     * @return False (policy unchanged) for any other name.
+     */
+    static bool parseArtifactPolicy(const std::string& name, ArtifactPolicy& policy);
+
     /**
      * @brief Generates a DOT visualization showing the isomorphism
      *        between two automata A and B.
@@ -0,0 +1,89 @@
+#ifndef EPSILON_CLOSURE_H
+#define EPSILON_CLOSURE_H
+
+#include "CSRAutomaton.h"
+#include "StateSet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class EpsilonClosure
+ *
+ * @brief ε-closures of every state of an ε-NFA, computed once.
+ *
+ * @details
+ * The ε-edge graph is condensed into its strongly connected components
+ * (Tarjan, iterative).  States of one component have the same closure, and
+ * Tarjan finishes a component only after every component it reaches, so
+ * one pass in finishing order builds each closure as
+ *
+ *     closure(C) = C ∪ ⋃ closure(C')   over ε-edges C → C'
+ *
+ * with one bitset per component, shared by its states.  A state with no
+ * ε-edges out of it is its own closure and needs no bitset.
+ *
+ * addTo() then replaces a graph search by a word-parallel OR.  The table
+ * costs one row of ⌈n/64⌉ words per non-trivial component; if that would
+ * exceed the memory budget, addTo() falls back to a depth-first search of
+ * a private copy of the ε-edges instead.
+ */
+class EpsilonClosure {
+public:
+
+    /**
+     * @param A            ε-NFA in CSR form (ε-edges in its ε-arrays).
+     * @param memoryBudget Largest closure table, in bytes.
+     */
+    explicit EpsilonClosure(const CSRAutomaton& A, size_t memoryBudget = 64u << 20);
+
+    /**
+     * @brief S ∪= ε-closure(q).
+     *
+     * S must only ever hold unions of whole ε-closures (as every subset
+     * built with addTo() does): then q ∈ S means its closure is in S
+     * already, and the call returns at once.
+     */
+    void addTo(uint32_t q, StateSet& S) const {
+        if (S.contains(q)) return;
+
+        uint32_t r = rowOf[component[q]];
+        if (r == NONE) {
+            S.insert(q);
+        } else if (precomputed) {
+            S.unionWith(rows.data() + (size_t)r * wordsPerSet);
+        } else {
+            search(q, S);
+        }
+    }
+
+    /// Number of strongly connected components of the ε-graph.
+    uint32_t numComponents() const {
+        return (uint32_t)rowOf.size();
+    }
+
+    /// False if the table was over budget and closures are searched.
+    bool isPrecomputed() const {
+        return precomputed;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t wordsPerSet;
+    bool precomputed = true;
+
+    std::vector<uint32_t> component;    ///< State → component
+    std::vector<uint32_t> rowOf;        ///< Component → row of rows, NONE if trivial
+    std::vector<uint64_t> rows;         ///< Closure bitsets, wordsPerSet words each
+
+    // ε-edges, kept only when the table is over budget.
+    std::vector<uint32_t> epsilonOffset;
+    std::vector<uint32_t> epsilonTargets;
+
+    /// Depth-first fallback for tables over budget.
+    void search(uint32_t q, StateSet& S) const;
+};
+
+#endif
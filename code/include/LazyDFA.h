@@ -0,0 +1,120 @@
+#ifndef LAZY_DFA_H
+#define LAZY_DFA_H
+
+#include "Automaton.h"
+#include "CSRAutomaton.h"
+#include "EpsilonClosure.h"
+#include "StateSet.h"
+#include "SubsetTable.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class LazyDFA
+ *
+ * @brief On-demand subset construction over an (ε-)NFA, for matching.
+ *
+ * @details
+ * Instead of running Automaton::determinise up front, a LazyDFA creates a
+ * DFA state (a subset of NFA states, ε-closed) only when an input symbol
+ * first leads to it, and remembers the transition in a table:
+ *
+ *     next[ state * |Σ| + column ]   (UNKNOWN until first taken)
+ *
+ * so repeated symbols cost one array lookup, like a real DFA.
+ *
+ * The cache is bounded: when its memory use passes the budget given to
+ * the constructor, every cached state is dropped (a "flush") and
+ * construction restarts from the state being expanded.  Memory is thus
+ * O(budget) even when the full DFA would have millions of states.
+ *
+ * The empty subset is not cached; it is the fixed id DEAD, whose every
+ * transition is DEAD again, so a scan can stop as soon as it is reached.
+ *
+ * A LazyDFA is not thread-safe; use one per thread.
+ */
+class LazyDFA {
+public:
+
+    /// Transition not computed yet.
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    /// The empty subset: no NFA state is alive.
+    static constexpr uint32_t DEAD = UINT32_MAX - 1;
+
+    /**
+     * @param nfa          NFA or ε-NFA ('#' = ε); its CSR form is copied.
+     * @param memoryBudget Cache size, in bytes, that triggers a flush.
+     */
+    explicit LazyDFA(const Automaton& nfa, size_t memoryBudget = 8u << 20);
+
+    /// DFA state for the ε-closure of the initial states.
+    uint32_t start();
+
+    /**
+     * @brief δ(state, c), building the successor if needed.
+     *
+     * If this call flushes the cache, every previously returned id except
+     * the result becomes invalid.
+     */
+    uint32_t step(uint32_t state, char c) {
+        if (state == DEAD) return DEAD;
+
+        int col = nfa.column(c);
+        if (col < 0) return DEAD;
+
+        uint32_t t = next[(size_t)state * k + (uint32_t)col];
+        return t != UNKNOWN ? t : computeNext(state, (uint32_t)col);
+    }
+
+    bool isFinal(uint32_t state) const {
+        return state != DEAD && finals[state] != 0;
+    }
+
+    /// True if the NFA accepts the whole input.
+    bool accepts(std::string_view input);
+
+    /// Number of DFA states currently cached.
+    uint32_t numCached() const {
+        return table.size();
+    }
+
+    /// Number of flushes so far.
+    size_t numFlushes() const {
+        return flushes;
+    }
+
+    /// Bytes of cached states and transitions (compared to the budget).
+    size_t memoryUsage() const;
+
+private:
+    CSRAutomaton nfa;
+    EpsilonClosure closure;         ///< Precomputed ε-closures of nfa
+    uint32_t n;
+    uint32_t k;
+    size_t budget;
+
+    SubsetTable table;              ///< Cached subsets → state id
+    std::vector<uint32_t> next;     ///< Cached transitions, row-major
+    std::vector<uint8_t> finals;    ///< finals[s] ⇔ s contains a final NFA state
+
+    StateSet initialSet;
+    StateSet finalMask;
+    uint32_t startState = UNKNOWN;
+    size_t flushes = 0;
+
+    // Scratch.
+    StateSet current;
+    StateSet successor;
+
+    uint32_t computeNext(uint32_t state, uint32_t col);
+
+    /// Id of an ε-closed, non-empty subset, caching it if new.
+    uint32_t intern(const StateSet& S);
+
+    void flush();
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef REGEX_AST_H
 #define REGEX_AST_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -20,6 +22,8 @@
  */
 enum class RKind { EMPTYSET, EPS, LITERAL, UNION, CONCAT, STAR };
 
+class RegexArena;
+
 /*
  * Regex
  *
@@ -32,17 +36,24 @@ enum class RKind { EMPTYSET, EPS, LITERAL, UNION, CONCAT, STAR };
  *   - STAR     : 'child'    holds the repeated subexpression
  *   - EPS and EMPTYSET have no child data
  *
- * Factory functions (makeEmpty, makeEps, makeLit, etc.) are used to build
- * these nodes consistently. The toString(), key(), and cost() methods
- * support printing, canonicalization, and heuristic comparisons.
+ * Nodes are immutable and hash-consed: the factory functions (makeEmpty,
+ * makeEps, makeLit, etc.) look the node up in a global table of live
+ * nodes, so structurally equal subtrees are the same pointer.  Hence
+ *
+ *   - structural equality is pointer equality (a == b);
+ *   - hash(), size() and cost() are computed once, at construction.
+ *
+ * Inside a RegexArena (see RegexArena.h) the factories allocate from the
+ * arena instead, with the same identity guarantee.
+ *
+ * The toString(), key(), and cost() methods support printing,
+ * canonicalization, and heuristic comparisons.
  */
 struct Regex {
-    RKind kind;                                // Type of AST node
-    char literal;                              // Used only when kind == LITERAL
-    std::vector<std::shared_ptr<Regex>> children; // Used for UNION and CONCAT
-    std::shared_ptr<Regex> child;              // Used for STAR
-
-    Regex(RKind k = RKind::EMPTYSET);
+    const RKind kind;                                // Type of AST node
+    const char literal;                              // Used only when kind == LITERAL
+    const std::vector<std::shared_ptr<Regex>> children; // Used for UNION and CONCAT
+    const std::shared_ptr<Regex> child;              // Used for STAR
 
     static std::shared_ptr<Regex> makeEmpty();
     static std::shared_ptr<Regex> makeEps();
@@ -54,25 +65,70 @@ struct Regex {
     /*
      * toString()
      * Converts the AST subtree rooted at this node into a printable
-     * regex string following the project's formatting rules.
+     * regex string following the project's formatting rules. The
+     * traversal is iterative and writes into one buffer sized from
+     * the cached length, so deep or huge trees print in linear time.
      */
     std::string toString() const;
 
     /*
      * key()
      * Produces a canonical string uniquely describing the structure
-     * of the AST node. Used for sorting child vectors and detecting
-     * structural equivalence between ASTs.
+     * of the AST node. Kept for printing and debugging; comparisons
+     * should use compareKey() or pointer equality instead. Iterative,
+     * like toString().
      */
     std::string key() const;
 
+    /*
+     * compareKey(other)
+     * Three-way comparison of key() and other.key() (negative, zero,
+     * positive) without building either string. Subtrees shared by
+     * both sides are skipped by pointer, so comparing nodes that
+     * differ early costs O(1). Used for sorting UNION children.
+     */
+    int compareKey(const Regex &other) const;
+
     /*
      * cost()
-     * Computes a heuristic size/cost measure used by the normalizer
-     * when comparing alternative rewritings (e.g., distributed vs.
+     * Heuristic size/cost measure used by the normalizer when
+     * comparing alternative rewritings (e.g., distributed vs.
      * factored forms). Lower cost indicates a simpler expression.
      */
-    int cost() const;
+    int cost() const { return costValue; }
+
+    /* Number of nodes in the subtree (shared subtrees counted per use). */
+    size_t size() const { return sizeValue; }
+
+    /* Structural 64-bit hash; equal for structurally equal trees. */
+    uint64_t hash() const { return hashValue; }
+
+    /* Length of toString(), without building it. */
+    size_t textLength() const { return textValue; }
+
+private:
+    /* Only the factories can construct nodes. */
+    struct Token {
+    private:
+        Token() {}
+        friend struct Regex;
+    };
+
+    friend class RegexArena;
+
+    const uint64_t hashValue;
+    const size_t sizeValue;
+    const int costValue;
+    const size_t textValue;
+    const RegexArena *const owner;      /* null for globally tabled nodes */
+
+    static std::shared_ptr<Regex> intern(RKind k, char lit,
+                                         std::vector<std::shared_ptr<Regex>> kids,
+                                         std::shared_ptr<Regex> c);
+
+public:
+    Regex(Token, RKind k, char lit, std::vector<std::shared_ptr<Regex>> kids,
+          std::shared_ptr<Regex> c, uint64_t h, const RegexArena *arena);
 };
 
 #endif
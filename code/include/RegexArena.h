@@ -0,0 +1,72 @@
+#ifndef REGEX_ARENA_H
+#define REGEX_ARENA_H
+
+#include "RegexAST.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/*
+ * RegexArena
+ *
+ * Scoped allocation session for Regex nodes.
+ *
+ * While an arena is alive, the Regex::make* factories called on the same
+ * thread place new nodes (object and reference count in one block) in
+ * the arena's monotonic buffer and hash-cons them in the arena's own
+ * open-addressing table, without taking the global lock. Nodes are
+ * never freed one by one: the arena keeps them all and releases the
+ * whole buffer when it is destroyed.
+ *
+ * Identity is preserved across scopes: a factory first looks for the node
+ * in this arena and in every enclosing arena, then (when all its children
+ * are ordinary nodes) in the global table, and only then creates it.
+ *
+ * Arenas nest and must be destroyed in reverse order of creation. No
+ * node created inside an arena may be used after the arena is gone, so
+ * sessions should hand back plain values (strings, automata):
+ *
+ *     std::string minimizeRegex(const std::string &s) {
+ *         RegexArena arena;
+ *         ...
+ *         return outAst->toString();
+ *     }
+ */
+class RegexArena {
+public:
+    explicit RegexArena(size_t initialBytes = 64 * 1024);
+    ~RegexArena();
+
+    RegexArena(const RegexArena &) = delete;
+    RegexArena &operator=(const RegexArena &) = delete;
+
+    /* Number of nodes owned by this arena. */
+    size_t size() const { return nodes.size(); }
+
+private:
+    friend struct Regex;
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    std::pmr::monotonic_buffer_resource buffer;
+    std::pmr::vector<std::shared_ptr<Regex>> nodes;  /* creation order */
+    std::pmr::vector<uint64_t> hashes;               /* hashes[i] = nodes[i]->hash() */
+    std::pmr::vector<uint32_t> slots;                /* linear probing: index into nodes / NONE */
+    RegexArena *enclosing;
+
+    /* Index of the node equal to (k, lit, kids, c), or NONE. */
+    uint32_t find(uint64_t h, RKind k, char lit,
+                  const std::vector<std::shared_ptr<Regex>> &kids,
+                  const std::shared_ptr<Regex> &c) const;
+
+    /* Appends a new node; doubles slots to keep the load at most 1/2. */
+    void add(const std::shared_ptr<Regex> &node);
+
+    /* Innermost live arena of this thread, or null. */
+    static thread_local RegexArena *innermost;
+};
+
+#endif
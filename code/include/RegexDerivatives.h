@@ -0,0 +1,54 @@
+#ifndef REGEX_DERIVATIVES_H
+#define REGEX_DERIVATIVES_H
+
+#include "Automaton.h"
+#include "RegexAST.h"
+
+#include <memory>
+
+/*
+ * regexToDerivativeDFA(r)
+ *
+ * Builds a DFA for r directly from the AST with Brzozowski derivatives:
+ *
+ *   d_a(∅) = d_a(#) = ∅
+ *   d_a(b)         = # if a == b, else ∅
+ *   d_a(r|s)       = d_a(r) | d_a(s)
+ *   d_a(r s)       = d_a(r) s | (d_a(s) if nullable(r))
+ *   d_a(r*)        = d_a(r) r*
+ *
+ * Every state is a derivative of r, normalised with normalizeRegexAST
+ * (flattening, ACI of union, ε/∅ laws), so only finitely many distinct
+ * derivatives arise.  Normalised nodes are hash-consed by key(), which
+ * makes state identity a pointer comparison and lets derivatives of
+ * shared subexpressions be computed once.
+ *
+ * States are numbered in BFS order from 0 (the initial state, r itself);
+ * a state is final iff its expression is nullable.  The DFA is complete
+ * over the literals of r: the ∅ derivative, if reached, is the sink.
+ *
+ * No ε-NFA, ε-removal or subset construction is involved, and the result
+ * is usually close to minimal.
+ */
+Automaton regexToDerivativeDFA(const std::shared_ptr<Regex>& r);
+
+/*
+ * regexToAntimirov(r)
+ *
+ * Builds the partial-derivative (Antimirov) NFA of r.  Partial derivatives
+ * split unions into separate states instead of keeping them in one term:
+ *
+ *   pd_a(∅) = pd_a(#) = {}
+ *   pd_a(b)          = {#} if a == b, else {}
+ *   pd_a(r|s)        = pd_a(r) ∪ pd_a(s)
+ *   pd_a(r s)        = { t s : t ∈ pd_a(r) } ∪ (pd_a(s) if nullable(r))
+ *   pd_a(r*)         = { t r* : t ∈ pd_a(r) }
+ *
+ * The NFA has r and its reachable partial derivatives as states (at most
+ * n + 1 for n literals, and usually fewer than the Glushkov automaton),
+ * with p --a--> q for q ∈ pd_a(p).  It has no ε-transitions; state 0 is
+ * the initial state and finals are the nullable terms.
+ */
+Automaton regexToAntimirov(const std::shared_ptr<Regex>& r);
+
+#endif
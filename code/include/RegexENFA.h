@@ -2,6 +2,7 @@
 #define REGEX_ENFA_H
 
 #include "Automaton.h"
+#include "RegexAST.h"
 #include <string>
 
 /**
@@ -39,6 +40,19 @@
  */
 Automaton regexToENFA(const std::string& inputBaseName);
 
+/**
+ * @brief Thompson’s construction from a parsed regex, in memory.
+ *
+ * @details
+ * Same construction as regexToENFA(const std::string&), applied to the
+ * Regex AST (n-ary unions and concatenations are built in one step).
+ * Nothing is read, written or rendered, and the call is thread-safe.
+ *
+ * @param r The regular expression.
+ * @return The constructed ε-NFA (one initial and one final state).
+ */
+Automaton regexToENFA(const Regex& r);
+
 /**
  * @brief Converts an ε-NFA (ENFA) into a standard NFA
  *        by removing all ε-transitions.
@@ -73,4 +87,16 @@ Automaton regexToENFA(const std::string& inputBaseName);
  */
 Automaton eNFAtoNFA(const std::string& inputBaseName);
 
+/**
+ * @brief ε-removal of an ε-NFA held in memory.
+ *
+ * @details
+ * The construction of eNFAtoNFA(const std::string&) without reading the
+ * ε-NFA from file and without writing or rendering the result.
+ *
+ * @param E The ε-NFA ('#' = ε).
+ * @return The equivalent NFA.
+ */
+Automaton eNFAtoNFA(const Automaton& E);
+
 #endif
@@ -0,0 +1,33 @@
+#ifndef REGEX_NFA_H
+#define REGEX_NFA_H
+
+#include "Automaton.h"
+#include "RegexAST.h"
+
+#include <memory>
+
+/*
+ * regexToGlushkov(r)
+ *
+ * Builds the Glushkov (position) automaton of a regex AST.
+ *
+ * Every LITERAL occurrence is a "position" 1..n, numbered left to right.
+ * From the AST we compute, bottom-up:
+ *
+ *   nullable(r) : ε ∈ L(r)
+ *   first(r)    : positions that can start a word of L(r)
+ *   last(r)     : positions that can end a word of L(r)
+ *   follow(p)   : positions that can come right after p
+ *
+ * The NFA has states 0..n (0 = initial, i = "just read position i"):
+ *
+ *   0 --a--> p   for p ∈ first(r),  a = symbol of p
+ *   p --a--> q   for q ∈ follow(p), a = symbol of q
+ *   finals       = last(r), plus 0 if nullable(r)
+ *
+ * The result has no ε-transitions, so it can go straight into
+ * Automaton::determinise without eNFAtoNFA and without any file I/O.
+ */
+Automaton regexToGlushkov(const std::shared_ptr<Regex>& r);
+
+#endif
@@ -9,10 +9,15 @@
  *
  * Parses the input regular expression string into an AST (Regex).
  * The parser:
- *   - Inserts explicit concatenation operators.
- *   - Uses a shunting-yard style algorithm to handle precedence:
- *         '*'  >  concatenation  >  '|'
- *   - Builds Regex nodes for literals, union, concatenation, and star.
+ *   - Reads the input once, left to right, with an explicit stack of
+ *     open parentheses (no recursion).
+ *   - Handles precedence  '*'  >  concatenation  >  '|'.
+ *   - Builds Regex nodes for literals, union, concatenation, and star,
+ *     flattening nested concatenations and unions.  A closed group's
+ *     operands are spliced into an enclosing operator of the same kind
+ *     before any node is built, so each node is built (and hashed) once
+ *     and the whole parse is linear in the input length, however deeply
+ *     the groups nest.
  *
  * The resulting AST is the structural input for normalization,
  * minimization, and regex-to-automaton conversions.
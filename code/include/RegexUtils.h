@@ -1,17 +1,46 @@
 #ifndef REGEX_UTILS_H
 #define REGEX_UTILS_H
 
+#include "Automaton.h"
+#include "RegexAST.h"
+
+#include <memory>
 #include <string>
 
 /*
- * minimizeRegex(regexInput)
+ * RegexConstruction
+ *
+ * How a regex is turned into an automaton before determinisation:
+ *   - Thompson    : ε-NFA (regexToENFA), left to determinise() to close.
+ *   - Glushkov    : position automaton, n + 1 states for n literals.
+ *   - Antimirov   : partial-derivative automaton, at most n + 1 states.
+ *   - Derivatives : Brzozowski derivative DFA, often near minimal.
+ *
+ * All work on the AST in memory, without files; all but Thompson
+ * produce ε-free automata.  The minimal DFA, and so the regex read
+ * back from it, is the same whichever construction is used.
+ */
+enum class RegexConstruction { Thompson, Glushkov, Antimirov, Derivatives };
+
+/*
+ * regexToAutomaton(ast, construction)
+ *
+ * Builds an automaton (ε-NFA, NFA or DFA) for ast with the given
+ * construction, ready for Automaton::determinise.  No disk I/O and no
+ * Graphviz calls; the Thompson ε-NFA is returned without ε-removal.
+ */
+Automaton regexToAutomaton(const std::shared_ptr<Regex> &ast,
+                           RegexConstruction construction);
+
+/*
+ * minimizeRegex(regexInput, construction)
  *
  * Takes a regular expression as a string and performs full
  * minimization using the project's regex pipeline:
  *
  *   1. Parse into AST.
  *   2. Normalize and simplify (AST-level reduction).
- *   3. Convert to ENFA, then NFA.
+ *   3. Build an automaton of the AST (Glushkov NFA by default).
  *   4. Determinise to DFA.
  *   5. Minimize the DFA.
  *   6. Convert the minimal DFA back to a regex.
@@ -20,6 +49,7 @@
  * Returns the minimized regular expression as a string.
  * Used internally by multiple features, including option 10.
  */
-std::string minimizeRegex(const std::string &regexInput);
+std::string minimizeRegex(const std::string &regexInput,
+                          RegexConstruction construction = RegexConstruction::Glushkov);
 
 #endif
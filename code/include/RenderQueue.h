@@ -0,0 +1,90 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * @class RenderQueue
+ *
+ * @brief Renders DOT files to PNG with Graphviz in the background.
+ *
+ * @details
+ * submit() only queues a job and returns, so the algorithm thread never
+ * waits for a layout.  Each job runs its own `dot -Tpng <dot> -o <png>`
+ * process, started with posix_spawnp (no shell), on a ThreadPool whose
+ * size bounds the number of dot processes alive at once.  waitAll()
+ * blocks until every queued image is written.
+ *
+ * Since renders read their DOT file later, DOT files are replaced whole:
+ * writers write to stagingPath() and commitFile() renames the result
+ * into place, so a running dot keeps reading the version it opened.
+ * Images are rendered to a staging file too, and of several renders of
+ * one image only the most recently submitted that finishes is kept.
+ *
+ * Dot::generateImage() and Dot::generateIsomorphismDot() use shared().
+ */
+class RenderQueue {
+public:
+
+    /**
+     * @param maxProcesses Concurrent dot processes; 0 means
+     *                     std::thread::hardware_concurrency().
+     */
+    explicit RenderQueue(unsigned maxProcesses = 0);
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    /**
+     * @brief Queues the rendering of dotFile into imageFile (PNG).
+     *
+     * The directory of imageFile is created if needed.
+     */
+    void submit(const std::string& dotFile, const std::string& imageFile);
+
+    /// Blocks until every submitted image has been rendered (or failed).
+    void waitAll();
+
+    /// Jobs whose dot process could not start or did not exit with 0.
+    size_t failures() const {
+        return failed.load();
+    }
+
+    /// Process-wide queue used by the Dot class.
+    static RenderQueue& shared();
+
+    /// Unique temporary path next to path (same directory, so commitFile()
+    /// is a rename within one file system).
+    static std::string stagingPath(const std::string& path);
+
+    /**
+     * @brief Atomically replaces path with the complete stagingFile.
+     *
+     * @return False (stagingFile removed) if the rename fails.
+     */
+    static bool commitFile(const std::string& stagingFile, const std::string& path);
+
+private:
+    /// Generations of one image: the last queued and the last written.
+    struct ImageState {
+        uint64_t submitted = 0;
+        uint64_t published = 0;
+    };
+
+    std::atomic<size_t> failed{0};
+    std::mutex imagesLock;
+    std::map<std::string, ImageState> images;
+    ThreadPool pool;    ///< Declared last: drained before the rest is destroyed
+
+    /// Runs one dot process and waits for it (on a pool worker).
+    void render(const std::string& dotFile, const std::string& imageFile, uint64_t generation);
+};
+
+#endif
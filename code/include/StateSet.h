@@ -0,0 +1,163 @@
+#ifndef STATE_SET_H
+#define STATE_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class StateSet
+ *
+ * @brief Fixed-universe dynamic bitset of compact state indices.
+ *
+ * @details
+ * Used by the subset constructions in place of std::set<int>: a subset of
+ * an n-state automaton is ⌈n/64⌉ machine words, so
+ *
+ *   - union is a word-parallel OR,
+ *   - "contains a final state" is a word-parallel AND against a final mask,
+ *   - equality and ordering are word-wise comparisons,
+ *
+ * and no node is ever allocated per member.
+ *
+ * All sets that are combined must share the same universe size.
+ */
+class StateSet {
+public:
+
+    StateSet() = default;
+
+    /// Empty subset of { 0 .. universe-1 }.
+    explicit StateSet(uint32_t universe)
+        : words((universe + 63) / 64, 0) {}
+
+    void insert(uint32_t q) {
+        words[q >> 6] |= uint64_t(1) << (q & 63);
+    }
+
+    /// Inserts q; returns true if it was not already present.
+    bool add(uint32_t q) {
+        uint64_t bit = uint64_t(1) << (q & 63);
+        uint64_t& w = words[q >> 6];
+        if (w & bit) return false;
+        w |= bit;
+        return true;
+    }
+
+    bool contains(uint32_t q) const {
+        return (words[q >> 6] >> (q & 63)) & 1;
+    }
+
+    /// this ∪= other.
+    void unionWith(const StateSet& other) {
+        const uint64_t* src = other.words.data();
+        uint64_t* dst = words.data();
+        for (size_t i = 0, w = words.size(); i < w; i++) dst[i] |= src[i];
+    }
+
+    /// this ∪= the set stored in numWords() raw words.
+    void unionWith(const uint64_t* src) {
+        uint64_t* dst = words.data();
+        for (size_t i = 0, w = words.size(); i < w; i++) dst[i] |= src[i];
+    }
+
+    /// True if this ∩ other ≠ ∅.
+    bool intersects(const StateSet& other) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            if (words[i] & other.words[i]) return true;
+        }
+        return false;
+    }
+
+    bool empty() const {
+        for (uint64_t w : words) {
+            if (w) return false;
+        }
+        return true;
+    }
+
+    void clear() {
+        std::fill(words.begin(), words.end(), 0);
+    }
+
+    /// Number of members.
+    uint32_t count() const {
+        uint32_t c = 0;
+        for (uint64_t w : words) c += (uint32_t)__builtin_popcountll(w);
+        return c;
+    }
+
+    /// Calls f(q) for every member q, in increasing order.
+    template <class F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t w = words[i];
+            while (w) {
+                f((uint32_t)(i * 64 + __builtin_ctzll(w)));
+                w &= w - 1;
+            }
+        }
+    }
+
+    /// Members in increasing order.
+    std::vector<uint32_t> toVector() const {
+        std::vector<uint32_t> v;
+        forEach([&](uint32_t q) { v.push_back(q); });
+        return v;
+    }
+
+    const std::vector<uint64_t>& getWords() const {
+        return words;
+    }
+
+    /// Number of 64-bit words.
+    uint32_t numWords() const {
+        return (uint32_t)words.size();
+    }
+
+    /// Raw words, numWords() of them.
+    const uint64_t* data() const {
+        return words.data();
+    }
+
+    /// Overwrites the contents with numWords() raw words.
+    void assign(const uint64_t* src) {
+        std::copy(src, src + words.size(), words.begin());
+    }
+
+    /// 64-bit fingerprint of the raw words (see StateSet::hash()).
+    static uint64_t hashWords(const uint64_t* w, uint32_t n) {
+        uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+        for (uint32_t i = 0; i < n; i++) {
+            h = (h ^ w[i]) * 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+        }
+        h ^= h >> 29;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /// 64-bit fingerprint of the subset.
+    uint64_t hash() const {
+        return hashWords(words.data(), (uint32_t)words.size());
+    }
+
+    bool operator==(const StateSet& other) const {
+        return words == other.words;
+    }
+
+    bool operator!=(const StateSet& other) const {
+        return words != other.words;
+    }
+
+    /// Word-wise ordering, so StateSet can key an ordered map.
+    bool operator<(const StateSet& other) const {
+        return words < other.words;
+    }
+
+private:
+    std::vector<uint64_t> words;
+};
+
+#endif
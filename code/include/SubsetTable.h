@@ -0,0 +1,82 @@
+#ifndef SUBSET_TABLE_H
+#define SUBSET_TABLE_H
+
+#include "StateSet.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SubsetTable
+ *
+ * @brief Interning table for the subsets discovered by a subset
+ *        construction: maps each distinct StateSet to a dense id.
+ *
+ * @details
+ * Subsets are numbered 0, 1, 2, ... in insertion order, so the id of a
+ * subset is also its position in the BFS queue.
+ *
+ * Storage is flat:
+ *
+ *   - the words of subset i live in one contiguous arena at
+ *     arena[ i·W , (i+1)·W ), W = words per subset;
+ *   - fingerprints[i] is its 64-bit hash;
+ *   - slots is an open-addressing (linear probing) table of ids, kept at
+ *     most half full.
+ *
+ * A lookup hashes the subset once, then compares fingerprints and only
+ * on a fingerprint match compares the W words, so the expected cost is
+ * O(W) instead of O(W · log N) for an ordered map.
+ */
+class SubsetTable {
+public:
+
+    /// Sentinel for "no subset".
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /// Table for subsets of { 0 .. universe-1 }.
+    explicit SubsetTable(uint32_t universe);
+
+    /**
+     * @brief Returns the id of S, inserting it if it is new.
+     *
+     * @param S        Subset (same universe as the table).
+     * @param inserted Set to true if S was not present before.
+     */
+    uint32_t intern(const StateSet& S, bool& inserted) {
+        return intern(S, S.hash(), inserted);
+    }
+
+    /// As above, with S.hash() already computed.
+    uint32_t intern(const StateSet& S, uint64_t hash, bool& inserted);
+
+    /// Id of S, or NONE.
+    uint32_t find(const StateSet& S) const;
+
+    /// Copies subset id into out (which must have the table's universe).
+    void load(uint32_t id, StateSet& out) const {
+        out.assign(arena.data() + (size_t)id * wordsPerSet);
+    }
+
+    /// Number of subsets interned.
+    uint32_t size() const {
+        return (uint32_t)fingerprints.size();
+    }
+
+    /// Forgets every subset (ids restart at 0); keeps the allocations.
+    void clear();
+
+private:
+    uint32_t wordsPerSet;
+    std::vector<uint64_t> arena;        ///< size() × wordsPerSet words
+    std::vector<uint64_t> fingerprints; ///< Hash of each subset
+    std::vector<uint32_t> slots;        ///< Power-of-two table of ids / NONE
+
+    /// Slot holding the subset with words w and hash h, or the empty slot
+    /// where it would go.
+    size_t probe(const uint64_t* w, uint64_t h) const;
+
+    void grow();
+};
+
+#endif
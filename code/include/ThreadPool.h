@@ -0,0 +1,73 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ *
+ * @brief Fixed set of worker threads executing submitted tasks.
+ *
+ * @details
+ * Tasks are plain std::function<void()> taken from one FIFO queue.
+ * waitAll() blocks until the queue is empty and no task is running.
+ *
+ * parallelFor() is the data-parallel helper used by the algorithms: it
+ * splits [0, n) into chunks of `grain` indices that the workers claim
+ * dynamically, and tells the body which worker slot (0 .. size()-1) it
+ * runs in so per-worker scratch buffers need no locking.
+ */
+class ThreadPool {
+public:
+
+    /**
+     * @param numThreads Number of workers; 0 means
+     *                   std::thread::hardware_concurrency().
+     */
+    explicit ThreadPool(unsigned numThreads = 0);
+
+    /// Finishes queued tasks, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const {
+        return (unsigned)workers.size();
+    }
+
+    void submit(std::function<void()> task);
+
+    /// Blocks until every submitted task has finished.
+    void waitAll();
+
+    /**
+     * @brief Runs body(begin, end, worker) over [0, n) in chunks and waits.
+     *
+     * When n ≤ grain the body runs inline on the calling thread as
+     * worker 0, so small inputs pay no synchronisation.
+     */
+    void parallelFor(size_t n, size_t grain,
+                     const std::function<void(size_t, size_t, unsigned)>& body);
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+
+    size_t running = 0;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+#endif
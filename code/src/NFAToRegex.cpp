@@ -1,6 +1,7 @@
 #include "../include/NFAToRegex.h"
 #include "../include/RegexParser.h"
 #include "../include/RegexNormalize.h"
+#include "../include/RegexArena.h"
 
 #include <map>
 #include <set>
@@ -213,8 +214,10 @@ string automatonToRegex(const Automaton& A) {
     if (raw.empty()) return "";
 
     /*
-     * Parse and prettify the regex using AST normalizer.
+     * Parse and prettify the regex using AST normalizer. The nodes are
+     * only needed until the string is printed.
      */
+    RegexArena arena;
     auto ast = parseRegexToAST(raw);
     ast = prettifyRegexAST(ast);
 
@@ -0,0 +1,373 @@
+#include "../include/AutomatonView.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[4] = { 'M', 'T', 'P', 'A' };
+const uint32_t BYTE_ORDER_TAG = 0x01020304;
+
+/**
+ * @brief Fixed 64-byte header of the binary format.
+ */
+struct BinaryHeader {
+    char     magic[4];
+    uint32_t byteOrder;         ///< BYTE_ORDER_TAG as written by the producer
+    uint32_t version;
+    uint32_t numStates;
+    uint32_t numEdges;
+    uint32_t numTargets;
+    uint32_t numEpsTargets;
+    uint32_t alphabetLength;
+    uint32_t numSymbols;
+    uint32_t reserved0;
+    uint64_t totalSize;         ///< Bytes, header included
+    uint32_t reserved[4];
+};
+
+static_assert(sizeof(BinaryHeader) == 64, "binary header must be 64 bytes");
+
+size_t align8(size_t x) {
+    return (x + 7) & ~size_t(7);
+}
+
+/**
+ * @brief Byte offsets of the sections, derived from the header counts
+ *        alone (shared by writer and reader).
+ */
+struct Layout {
+    size_t stateIds, alphabet, symbols, rowOffsets, edgeColumns, targetOffsets,
+           targets, epsOffsets, epsTargets, initialBits, finalBits, end;
+
+    explicit Layout(const BinaryHeader& h) {
+        size_t n = h.numStates, m = h.numEdges, words = (n + 63) / 64;
+        size_t at = sizeof(BinaryHeader);
+
+        auto section = [&](size_t bytes) {
+            size_t start = at;
+            at = align8(at + bytes);
+            return start;
+        };
+
+        stateIds      = section(4 * n);
+        alphabet      = section(h.alphabetLength);
+        symbols       = section(h.numSymbols);
+        rowOffsets    = section(4 * (n + 1));
+        edgeColumns   = section(m);
+        targetOffsets = section(4 * (m + 1));
+        targets       = section(4 * (size_t)h.numTargets);
+        epsOffsets    = section(4 * (n + 1));
+        epsTargets    = section(4 * (size_t)h.numEpsTargets);
+        initialBits   = section(8 * words);
+        finalBits     = section(8 * words);
+        end = at;
+    }
+};
+
+/// Writes bytes, then zero padding up to the next 8-byte boundary.
+void writeSection(ofstream& out, const void* data, size_t bytes) {
+    static const char zeros[8] = {};
+    out.write((const char*)data, (streamsize)bytes);
+    out.write(zeros, (streamsize)(align8(bytes) - bytes));
+}
+
+} // namespace
+
+AutomatonView::~AutomatonView() {
+    release();
+}
+
+AutomatonView::AutomatonView(AutomatonView&& other) noexcept {
+    *this = std::move(other);
+}
+
+AutomatonView& AutomatonView::operator=(AutomatonView&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+
+    // All members are pointers and counts into the image: copy them, then
+    // leave other empty so only one of the two unmaps.
+    base = other.base;
+    mapping = other.mapping;
+    mappingSize = other.mappingSize;
+    lastError = std::move(other.lastError);
+    n = other.n; m = other.m; k = other.k;
+    numTargets = other.numTargets;
+    numEpsTargets = other.numEpsTargets;
+    alphabetLength = other.alphabetLength;
+    stateIds = other.stateIds;
+    alphabet = other.alphabet;
+    symbols = other.symbols;
+    rowOffsets = other.rowOffsets;
+    edgeColumns = other.edgeColumns;
+    targetOffsets = other.targetOffsets;
+    targets = other.targets;
+    epsOffsets = other.epsOffsets;
+    epsTargets = other.epsTargets;
+    initialBits = other.initialBits;
+    finalBits = other.finalBits;
+    memcpy(columnOf, other.columnOf, sizeof columnOf);
+
+    other.base = nullptr;
+    other.mapping = nullptr;
+    other.mappingSize = 0;
+    return *this;
+}
+
+void AutomatonView::release() {
+    if (mapping) munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    base = nullptr;
+}
+
+bool AutomatonView::fail(const string& why) {
+    release();
+    lastError = why;
+    return false;
+}
+
+/**
+ * @brief Maps the file and attaches to it.
+ *
+ * @details
+ * The mapping is private and read-only; pages are only read in when a
+ * query touches them, so opening is O(1) whatever the file size.
+ */
+bool AutomatonView::open(const string& path) {
+    release();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("cannot open " + path + ": " + strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        ::close(fd);
+        return fail("cannot stat " + path + " or file is empty");
+    }
+
+    size_t bytes = (size_t)st.st_size;
+    void* region = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (region == MAP_FAILED) return fail("cannot map " + path + ": " + strerror(errno));
+
+    if (!attach(region, bytes)) {
+        munmap(region, bytes);
+        return false;
+    }
+
+    mapping = region;
+    mappingSize = bytes;
+    return true;
+}
+
+/**
+ * @brief Points the accessors into an image after checking its header.
+ *
+ * Checks the magic, byte order, version and that every section fits in
+ * size bytes; section contents are left to verify().
+ */
+bool AutomatonView::attach(const void* data, size_t size) {
+    release();
+
+    if (((uintptr_t)data & 7) != 0) return fail("image is not 8-byte aligned");
+    if (size < sizeof(BinaryHeader)) return fail("image too small for its header");
+
+    BinaryHeader h;
+    memcpy(&h, data, sizeof h);
+
+    if (memcmp(h.magic, MAGIC, 4) != 0) return fail("not a binary automaton (bad magic)");
+    if (h.byteOrder != BYTE_ORDER_TAG)  return fail("binary automaton has the other byte order");
+    if (h.version != VERSION)           return fail("unsupported binary automaton version " + to_string(h.version));
+    if (h.numSymbols > 255)             return fail("too many symbols");
+
+    Layout L(h);
+    if (h.totalSize != L.end || size < L.end) return fail("image size does not match its header");
+
+    const unsigned char* p = (const unsigned char*)data;
+    base = p;
+
+    n = h.numStates;
+    m = h.numEdges;
+    k = h.numSymbols;
+    numTargets = h.numTargets;
+    numEpsTargets = h.numEpsTargets;
+    alphabetLength = h.alphabetLength;
+
+    stateIds      = (const int32_t*)(p + L.stateIds);
+    alphabet      = (const char*)(p + L.alphabet);
+    symbols       = (const char*)(p + L.symbols);
+    rowOffsets    = (const uint32_t*)(p + L.rowOffsets);
+    edgeColumns   = (const uint8_t*)(p + L.edgeColumns);
+    targetOffsets = (const uint32_t*)(p + L.targetOffsets);
+    targets       = (const uint32_t*)(p + L.targets);
+    epsOffsets    = (const uint32_t*)(p + L.epsOffsets);
+    epsTargets    = (const uint32_t*)(p + L.epsTargets);
+    initialBits   = (const uint64_t*)(p + L.initialBits);
+    finalBits     = (const uint64_t*)(p + L.finalBits);
+
+    fill(begin(columnOf), end(columnOf), (int16_t)-1);
+    for (uint32_t c = 0; c < k; c++) columnOf[(unsigned char)symbols[c]] = (int16_t)c;
+
+    lastError.clear();
+    return true;
+}
+
+/**
+ * @brief Checks that offsets are monotone and end at the section sizes,
+ *        that columns are in range and strictly increasing within each
+ *        row (findEdge() searches them), that the symbols are distinct
+ *        (column() maps each to one column), and that every target is a
+ *        state.
+ */
+bool AutomatonView::verify() const {
+    if (!base) return false;
+
+    auto monotone = [](const uint32_t* offsets, size_t count, uint32_t last) {
+        if (offsets[0] != 0 || offsets[count] != last) return false;
+        for (size_t i = 0; i < count; i++) {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        return true;
+    };
+
+    if (!monotone(rowOffsets, n, m))                  return false;
+    if (!monotone(targetOffsets, m, numTargets))      return false;
+    if (!monotone(epsOffsets, n, numEpsTargets))      return false;
+
+    for (uint32_t q = 0; q < n; q++) {
+        for (uint32_t e = rowOffsets[q]; e < rowOffsets[q + 1]; e++) {
+            if (edgeColumns[e] >= k) return false;
+            if (e > rowOffsets[q] && edgeColumns[e - 1] >= edgeColumns[e]) return false;
+        }
+    }
+    for (uint32_t c = 0; c < k; c++) {
+        if (columnOf[(unsigned char)symbols[c]] != (int16_t)c) return false;
+    }
+    for (uint32_t i = 0; i < numTargets; i++) {
+        if (targets[i] >= n) return false;
+    }
+    for (uint32_t i = 0; i < numEpsTargets; i++) {
+        if (epsTargets[i] >= n) return false;
+    }
+    for (uint32_t q = 0; q + 1 < n; q++) {
+        if (stateIds[q] >= stateIds[q + 1]) return false;
+    }
+    return true;
+}
+
+uint32_t AutomatonView::findEdge(uint32_t q, uint32_t col) const {
+    const uint8_t* first = edgeColumns + rowOffsets[q];
+    const uint8_t* last  = edgeColumns + rowOffsets[q + 1];
+    const uint8_t* it = lower_bound(first, last, col);
+    if (it == last || *it != col) return NONE;
+    return (uint32_t)(it - edgeColumns);
+}
+
+pair<const uint32_t*, const uint32_t*> AutomatonView::successors(uint32_t q, char c) const {
+    int col = column(c);
+    uint32_t e = col < 0 ? NONE : findEdge(q, (uint32_t)col);
+    if (e == NONE) return { targets, targets };
+    return { targetsBegin(e), targetsEnd(e) };
+}
+
+/**
+ * @brief Writes the CSR arrays of C section by section (see the format in
+ *        AutomatonView.h).
+ */
+bool AutomatonView::write(const CSRAutomaton& C, const string& path) {
+    uint32_t n = C.size();
+    size_t words = (n + 63) / 64;
+
+    BinaryHeader h{};
+    memcpy(h.magic, MAGIC, 4);
+    h.byteOrder      = BYTE_ORDER_TAG;
+    h.version        = VERSION;
+    h.numStates      = n;
+    h.numEdges       = C.numEdges();
+    h.numTargets     = (uint32_t)C.targets.size();
+    h.numEpsTargets  = (uint32_t)C.epsTargets.size();
+    h.alphabetLength = (uint32_t)C.alphabet.size();
+    h.numSymbols     = (uint32_t)C.symbols.size();
+    h.totalSize      = Layout(h).end;
+
+    vector<uint64_t> initialBits(words, 0), finalBits(words, 0);
+    for (uint32_t q : C.initialStates) initialBits[q >> 6] |= uint64_t(1) << (q & 63);
+    for (uint32_t q = 0; q < n; q++) {
+        if (C.finals[q]) finalBits[q >> 6] |= uint64_t(1) << (q & 63);
+    }
+
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) return false;
+
+    writeSection(out, &h, sizeof h);
+    writeSection(out, C.stateIds.data(),      4 * (size_t)n);
+    writeSection(out, C.alphabet.data(),      C.alphabet.size());
+    writeSection(out, C.symbols.data(),       C.symbols.size());
+    writeSection(out, C.rowOffsets.data(),    4 * (size_t)(n + 1));
+    writeSection(out, C.edgeColumns.data(),   C.edgeColumns.size());
+    writeSection(out, C.targetOffsets.data(), 4 * C.targetOffsets.size());
+    writeSection(out, C.targets.data(),       4 * C.targets.size());
+    writeSection(out, C.epsOffsets.data(),    4 * (size_t)(n + 1));
+    writeSection(out, C.epsTargets.data(),    4 * C.epsTargets.size());
+    writeSection(out, initialBits.data(),     8 * words);
+    writeSection(out, finalBits.data(),       8 * words);
+
+    return (bool)out;
+}
+
+CSRAutomaton AutomatonView::toCSR() const {
+    CSRAutomaton C;
+    if (!base) return C;
+
+    C.stateIds.assign(stateIds, stateIds + n);
+    C.alphabet.assign(alphabet, alphabetLength);
+    C.symbols.assign(symbols, k);
+    C.indexSymbols();
+
+    C.rowOffsets.assign(rowOffsets, rowOffsets + n + 1);
+    C.edgeColumns.assign(edgeColumns, edgeColumns + m);
+    C.targetOffsets.assign(targetOffsets, targetOffsets + m + 1);
+    C.targets.assign(targets, targets + numTargets);
+    C.epsOffsets.assign(epsOffsets, epsOffsets + n + 1);
+    C.epsTargets.assign(epsTargets, epsTargets + numEpsTargets);
+
+    C.finals.assign(n, 0);
+    for (uint32_t q = 0; q < n; q++) {
+        if (isInitial(q)) C.initialStates.push_back(q);
+        if (isFinal(q)) C.finals[q] = 1;
+    }
+    return C;
+}
+
+bool writeBinaryAutomaton(const Automaton& A, const string& path) {
+    return AutomatonView::write(A.freeze(), path);
+}
+
+Automaton readBinaryAutomaton(const string& path, string* error) {
+    AutomatonView view;
+
+    string why;
+    if (!view.open(path))      why = view.error();
+    else if (!view.verify())   why = path + " is corrupt";
+
+    if (error) *error = why;
+    if (!why.empty()) {
+        if (!error) cerr << "[ERROR] readBinaryAutomaton: " << why << "\n";
+        return Automaton();
+    }
+
+    return view.toCSR().toAutomaton();
+}
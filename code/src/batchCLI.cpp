@@ -0,0 +1,363 @@
+#include "../include/BatchCLI.h"
+#include "../include/Automaton.h"
+#include "../include/AutomatonView.h"
+#include "../include/Daemon.h"
+#include "../include/RegexUtils.h"
+#include "../include/ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Upper bound of --jobs; far more threads than cores only adds contention.
+const unsigned MAX_JOBS = 1024;
+
+/**
+ * @brief Options and inputs of one batch run.
+ */
+struct BatchJob {
+    string command;
+    MinimizationAlgorithm algorithm = MinimizationAlgorithm::Hopcroft;
+    RegexConstruction construction = RegexConstruction::Glushkov;
+    unsigned jobs = 0;
+    string outDir = "../../outputs";
+    vector<string> inputs;
+
+    // serve only
+    string socketPath;
+    size_t cacheEntries = 4096;
+    size_t cacheMegabytes = 256;
+};
+
+void printUsage() {
+    cerr << "Usage: mtp <command> [options] <file>...\n"
+         << "\n"
+         << "Commands:\n"
+         << "  determinise      automaton -> DFA           (dfa_<name>.txt)\n"
+         << "  minimize         automaton -> minimal DFA   (min_<name>.txt)\n"
+         << "  minimize-regex   regex -> minimized regex   (min_regex_<name>.txt)\n"
+         << "  to-binary        text automaton -> binary   (<name>.mtpa)\n"
+         << "  to-text          binary automaton -> text   (<name>.txt)\n"
+         << "  serve            NDJSON request server (stdin/stdout or --socket)\n"
+         << "\n"
+         << "Options:\n"
+         << "  --algo=moore|hopcroft|valmari\n"
+         << "  --construction=thompson|glushkov|antimirov|derivatives\n"
+         << "  --jobs=N         worker threads, 0..1024 (default: all cores)\n"
+         << "  --out=DIR        output directory (default: ../../outputs)\n"
+         << "  --socket=PATH    serve: Unix domain socket to listen on\n"
+         << "  --cache=N        serve: entries per warm cache (default: 4096)\n"
+         << "  --cache-mb=N     serve: megabytes per warm cache (default: 256)\n"
+         << "\n"
+         << "Without arguments the interactive menu starts.\n";
+}
+
+/**
+ * @brief Parses a non-negative decimal count no larger than max.
+ *
+ * Unlike stoul alone, rejects signs ("-1" would wrap to ULONG_MAX),
+ * blanks and trailing characters.
+ */
+bool parseCount(const string& value, size_t max, size_t& out) {
+    if (value.empty() || value.find_first_not_of("0123456789") != string::npos) return false;
+
+    try {
+        out = stoul(value);
+    } catch (...) {
+        return false;
+    }
+    return out <= max;
+}
+
+/**
+ * @brief Parses argv into a BatchJob.
+ *
+ * @return False (after printing why) on any usage error.
+ */
+bool parseArguments(int argc, char* argv[], BatchJob& job) {
+    job.command = argv[1];
+
+    if (job.command != "determinise" && job.command != "minimize" &&
+        job.command != "minimize-regex" && job.command != "to-binary" &&
+        job.command != "to-text" && job.command != "serve") {
+        cerr << "Unknown command: " << job.command << "\n";
+        return false;
+    }
+
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.rfind("--", 0) != 0) {
+            job.inputs.push_back(arg);
+            continue;
+        }
+
+        size_t eq = arg.find('=');
+        string name  = arg.substr(0, eq);
+        string value = (eq == string::npos) ? "" : arg.substr(eq + 1);
+
+        if (name == "--algo") {
+            if      (value == "moore")    job.algorithm = MinimizationAlgorithm::Moore;
+            else if (value == "hopcroft") job.algorithm = MinimizationAlgorithm::Hopcroft;
+            else if (value == "valmari")  job.algorithm = MinimizationAlgorithm::ValmariLehtinen;
+            else {
+                cerr << "Unknown minimization algorithm: " << value << "\n";
+                return false;
+            }
+        }
+        else if (name == "--construction") {
+            if      (value == "thompson")    job.construction = RegexConstruction::Thompson;
+            else if (value == "glushkov")    job.construction = RegexConstruction::Glushkov;
+            else if (value == "antimirov")   job.construction = RegexConstruction::Antimirov;
+            else if (value == "derivatives") job.construction = RegexConstruction::Derivatives;
+            else {
+                cerr << "Unknown regex construction: " << value << "\n";
+                return false;
+            }
+        }
+        else if (name == "--jobs") {
+            size_t jobs;
+            if (!parseCount(value, MAX_JOBS, jobs)) {
+                cerr << "Invalid --jobs value: " << value << " (expected 0.." << MAX_JOBS << ")\n";
+                return false;
+            }
+            job.jobs = (unsigned)jobs;
+        }
+        else if (name == "--socket") {
+            job.socketPath = value;
+        }
+        else if (name == "--cache") {
+            if (!parseCount(value, SIZE_MAX, job.cacheEntries)) {
+                cerr << "Invalid --cache value: " << value << "\n";
+                return false;
+            }
+        }
+        else if (name == "--cache-mb") {
+            if (!parseCount(value, SIZE_MAX >> 20, job.cacheMegabytes)) {
+                cerr << "Invalid --cache-mb value: " << value << "\n";
+                return false;
+            }
+        }
+        else if (name == "--out") {
+            if (value.empty()) {
+                cerr << "Empty --out directory\n";
+                return false;
+            }
+            job.outDir = value;
+        }
+        else {
+            cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (job.command == "serve") {
+        if (!job.inputs.empty()) {
+            cerr << "serve takes no input files\n";
+            return false;
+        }
+        return true;
+    }
+
+    if (job.inputs.empty()) {
+        cerr << "No input files\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Path of the file the job's command writes for inputPath.
+ */
+string outputPathOf(const BatchJob& job, const string& inputPath) {
+    string stem = filesystem::path(inputPath).stem().string();
+
+    if (job.command == "minimize-regex") return job.outDir + "/min_regex_" + stem + ".txt";
+    if (job.command == "to-binary")      return job.outDir + "/" + stem + ".mtpa";
+    if (job.command == "to-text")        return job.outDir + "/" + stem + ".txt";
+    if (job.command == "determinise")    return job.outDir + "/dfa_" + stem + ".txt";
+    return job.outDir + "/min_" + stem + ".txt";
+}
+
+/**
+ * @brief Reads an automaton input, text or binary (".mtpa").
+ *
+ * @return Empty string on success, otherwise the error message: the first
+ *         malformed line of a text file, or why a binary file is invalid.
+ */
+string readInput(const string& inputPath, Automaton& A) {
+    if (filesystem::path(inputPath).extension() == ".mtpa") {
+        string error;
+        A = readBinaryAutomaton(inputPath, &error);
+        return error;
+    }
+
+    ifstream fin(inputPath, ios::binary);
+    if (!fin.is_open()) return "cannot open file";
+
+    string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+    if (fin.bad()) return "cannot read file";
+
+    vector<Automaton::ParseError> errors;
+    A = Automaton::parseAutomaton(text, &errors);
+    if (errors.empty()) return "";
+
+    string message = "line " + to_string(errors[0].line) + ": " + errors[0].message;
+    if (errors.size() > 1) message += " (and " + to_string(errors.size() - 1) + " more malformed line(s))";
+    return message;
+}
+
+/**
+ * @brief Runs the job's command on one input file and writes its result.
+ *
+ * @return Empty string on success, otherwise the error message.
+ */
+string processFile(const BatchJob& job, const string& inputPath) {
+    string outputPath = outputPathOf(job, inputPath);
+
+    if (job.command == "minimize-regex") {
+        ifstream fin(inputPath);
+        if (!fin.is_open()) return "cannot open file";
+
+        string regex;
+        getline(fin, regex);
+
+        ofstream fout(outputPath);
+        if (!fout.is_open()) return "cannot write " + outputPath;
+
+        fout << minimizeRegex(regex, job.construction);
+        fout.close();
+        return fout ? "" : "cannot write " + outputPath;
+    }
+
+    Automaton A;
+    string error = readInput(inputPath, A);
+    if (!error.empty()) return error;
+
+    if (job.command == "to-binary") {
+        return writeBinaryAutomaton(A, outputPath) ? "" : "cannot write " + outputPath;
+    }
+
+    Automaton result;
+
+    if (job.command == "to-text") {
+        result = A;
+    } else if (job.command == "determinise") {
+        result = Automaton::determinise(A);
+    } else {
+        // Valmari–Lehtinen works on the partial DFA; the others need it complete.
+        bool complete = job.algorithm != MinimizationAlgorithm::ValmariLehtinen;
+
+        result = Automaton::minimize(Automaton::determinise(A, complete), job.algorithm);
+    }
+
+    return result.writeAutomaton(outputPath) ? "" : "cannot write " + outputPath;
+}
+
+/**
+ * @brief Checks that no two inputs write the same output file (inputs
+ *        with the same stem in different directories would otherwise
+ *        overwrite each other from two workers).
+ *
+ * @return False (after printing every clash) if some output is shared.
+ */
+bool checkDistinctOutputs(const BatchJob& job) {
+    map<string, const string*> writer;
+    bool distinct = true;
+
+    for (const string& input : job.inputs) {
+        auto [it, inserted] = writer.emplace(outputPathOf(job, input), &input);
+        if (!inserted) {
+            cerr << input << " and " << *it->second << " would both write " << it->first << "\n";
+            distinct = false;
+        }
+    }
+    return distinct;
+}
+
+} // namespace
+
+/**
+ * @brief Batch mode of the toolkit (see BatchCLI.h).
+ *
+ * @details
+ * 1. Parse the command, options and input files; refuse inputs whose
+ *    output files would clash.
+ * 2. Create the output directory if needed.
+ * 3. Process the files with ThreadPool::parallelFor, one file per chunk
+ *    so that slow files do not hold up a whole chunk.  Each worker writes
+ *    its own output files; only the error log takes a lock.
+ * 4. Print a one-line summary to stderr.
+ */
+int runBatch(int argc, char* argv[]) {
+    // ------ Step 1: Arguments
+    BatchJob job;
+    if (!parseArguments(argc, argv, job)) {
+        printUsage();
+        return 2;
+    }
+
+    if (job.command == "serve") {
+        DaemonOptions options;
+        options.socketPath = job.socketPath;
+        options.jobs = job.jobs;
+        options.cacheEntries = job.cacheEntries;
+        options.cacheBytes = job.cacheMegabytes << 20;
+        return runDaemon(options);
+    }
+
+    if (!checkDistinctOutputs(job)) return 2;
+
+    // ------ Step 2: Output directory
+    error_code ec;
+    filesystem::create_directories(job.outDir, ec);
+    if (ec) {
+        cerr << "Cannot create output directory " << job.outDir << ": " << ec.message() << "\n";
+        return 2;
+    }
+
+    // ------ Step 3: Process all files concurrently
+    auto start = chrono::steady_clock::now();
+
+    ThreadPool pool(job.jobs);
+    mutex logLock;
+    atomic<size_t> failed(0);
+
+    pool.parallelFor(job.inputs.size(), 1, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; i++) {
+            string error;
+            try {
+                error = processFile(job, job.inputs[i]);
+            } catch (const exception& e) {
+                error = e.what();
+            }
+
+            if (!error.empty()) {
+                failed++;
+                lock_guard<mutex> guard(logLock);
+                cerr << job.inputs[i] << ": " << error << "\n";
+            }
+        }
+    });
+
+    // ------ Step 4: Summary
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cerr << job.command << ": " << job.inputs.size() << " file(s), "
+         << failed << " failed, " << pool.size() << " worker(s), "
+         << seconds << " s\n";
+
+    return failed == 0 ? 0 : 1;
+}
@@ -73,17 +73,11 @@ void brozozowskisAlgorithm(const Automaton& nonDeterministicAutomaton, const str
     // and minimal — this is the minimal DFA equivalent to the original automaton.
     Automaton bro_DFA = Automaton::determinise(det1t);
 
-    // Step 5: Write the resulting minimal DFA to a text file.
-    bro_DFA.writeAutomaton(outputFilePath);
-
-    // Step 6: Generate visualization for the minimized automaton.
-    // -----------------------------------------------------------
-    // Create an instance of the Dot class for generating DOT and image files.
+    // Step 5: Write the resulting minimal DFA to a text file and generate
+    //         its DOT + PNG visualization (as far as the artifact policy allows).
+    // ----------------------------------------------------------------------
     Dot dotGenerator;
 
-    // Generate the DOT file representing the minimized automaton.
-    dotGenerator.generateDot(outputFilePath, outputDotFilePath, "bro_DFA");
-
-    // Generate a visual image (e.g., PNG/SVG) from the DOT file.
-    dotGenerator.generateImage(outputDotFilePath, "bro_", inputBaseName);
+    dotGenerator.writeArtifacts(bro_DFA, outputFilePath, outputDotFilePath,
+                                "bro_DFA", "bro_", inputBaseName);
 }
@@ -53,17 +53,13 @@ Automaton createNonDeterministicAutomaton(const string& inputBaseName) {
     // The Automaton class handles parsing the structure (states, transitions, etc.).
     Automaton nonDeterministicAutomaton = Automaton::readAutomaton(inputTextFilePath);
 
-    // Step 4: Create a Dot utility instance for visualization.
+    // Step 4: Generate the DOT file (graph title "NFA") and the image
+    // "nfa_<inputBaseName>.png" from the automaton just read, as far as the
+    // artifact policy allows.  No text file: the input is one already.
     Dot dotGenerator;
+    dotGenerator.writeArtifacts(nonDeterministicAutomaton, "", outputDotFilePath,
+                                "NFA", "nfa_", inputBaseName);
 
-    // Step 5: Generate the DOT file describing the automaton graph.
-    // The label "NFA" will appear in the graph title.
-    dotGenerator.generateDot(inputTextFilePath, outputDotFilePath, "NFA");
-
-    // Step 6: Generate an image (e.g., PNG or SVG) from the DOT file.
-    // The output image will be named like "nfa_<inputBaseName>.png".
-    dotGenerator.generateImage(outputDotFilePath, "nfa_", inputBaseName);
-
-    // Step 7: Return the constructed NFA for further processing.
+    // Step 5: Return the constructed NFA for further processing.
     return nonDeterministicAutomaton;
 }
@@ -0,0 +1,309 @@
+#include "../include/CSRAutomaton.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+/**
+ * @brief Returns the cached CSR form of the automaton, building it on first
+ *        use.
+ *
+ * @details
+ * The cache is published with an atomic shared_ptr compare-exchange.
+ * Threads racing on an empty cache may each build a copy, but only the
+ * first one published is kept and returned to all of them; the others
+ * are discarded before anyone holds a reference to them.
+ */
+const CSRAutomaton& Automaton::freeze() const {
+    shared_ptr<const CSRAutomaton> cached = atomic_load(&frozen);
+    if (cached) return *cached;
+
+    auto built = make_shared<const CSRAutomaton>(CSRAutomaton::fromAutomaton(*this));
+
+    // On failure `cached` receives the copy another thread published.
+    if (atomic_compare_exchange_strong(&frozen, &cached, built)) return *built;
+    return *cached;
+}
+
+/**
+ * @brief Rebuilds the symbol → column lookup table.
+ */
+void CSRAutomaton::indexSymbols() {
+    fill(begin(columnOf), end(columnOf), -1);
+    for (size_t i = 0; i < symbols.size(); i++) {
+        columnOf[(unsigned char)symbols[i]] = (int)i;
+    }
+}
+
+/**
+ * @brief Compact index of an original state id (binary search), or NONE.
+ */
+uint32_t CSRAutomaton::indexOf(int id) const {
+    auto it = lower_bound(stateIds.begin(), stateIds.end(), id);
+    if (it == stateIds.end() || *it != id) return NONE;
+    return (uint32_t)(it - stateIds.begin());
+}
+
+/**
+ * @brief Edge of q labelled with column col, or NONE.
+ */
+uint32_t CSRAutomaton::findEdge(uint32_t q, uint32_t col) const {
+    auto first = edgeColumns.begin() + rowOffsets[q];
+    auto last  = edgeColumns.begin() + rowOffsets[q + 1];
+    auto it = lower_bound(first, last, col);
+
+    if (it == last || *it != col) return NONE;
+    return (uint32_t)(it - edgeColumns.begin());
+}
+
+/**
+ * @brief Freezes a map-based Automaton into CSR form.
+ *
+ * @details
+ * 1. Compact every mentioned state id (sorted, so rank order = id order).
+ * 2. Columns = non-'#' symbols of Σ ∪ transition symbols, sorted.
+ * 3. Walk the transition map once.  Because it is ordered by
+ *    (from, symbol), each state's edges come out contiguous and
+ *    symbol-sorted, and each std::set of targets is already sorted.
+ *
+ * @param A Source automaton.
+ * @return  Its CSR form.
+ */
+CSRAutomaton CSRAutomaton::fromAutomaton(const Automaton& A) {
+    CSRAutomaton C;
+
+    // --------------------------------------------------------------
+    // Step 1: Compact state ids.
+    // --------------------------------------------------------------
+    C.stateIds.assign(A.states.begin(), A.states.end());
+    bool extra = false;
+
+    auto mention = [&](int s) {
+        if (!A.states.count(s)) {
+            C.stateIds.push_back(s);
+            extra = true;
+        }
+    };
+
+    for (auto& [key, to] : A.transitions) {
+        mention(key.first);
+        for (int t : to) mention(t);
+    }
+    for (int s : A.initialStates) mention(s);
+    for (int s : A.finalStates)   mention(s);
+
+    if (extra) {
+        sort(C.stateIds.begin(), C.stateIds.end());
+        C.stateIds.erase(unique(C.stateIds.begin(), C.stateIds.end()), C.stateIds.end());
+    }
+
+    uint32_t n = C.size();
+    bool identity = n == 0 ||
+                    (C.stateIds.front() == 0 && C.stateIds.back() == (int)n - 1);
+
+    auto idx = [&](int s) -> uint32_t {
+        return identity ? (uint32_t)s : C.indexOf(s);
+    };
+
+    // --------------------------------------------------------------
+    // Step 2: Columns.
+    // --------------------------------------------------------------
+    C.alphabet.assign(A.alphabet.begin(), A.alphabet.end());
+
+    set<char> cols;
+    for (char c : A.alphabet) {
+        if (c != '#') cols.insert(c);
+    }
+    for (auto& [key, to] : A.transitions) {
+        if (key.second != '#') cols.insert(key.second);
+    }
+    C.symbols.assign(cols.begin(), cols.end());
+    C.indexSymbols();
+
+    // --------------------------------------------------------------
+    // Step 3: Rows.
+    // --------------------------------------------------------------
+    C.rowOffsets.assign(n + 1, 0);
+    C.epsOffsets.assign(n + 1, 0);
+    C.targetOffsets.push_back(0);
+
+    uint32_t row = 0;   // next row whose start offsets are not yet written
+
+    for (auto& [key, to] : A.transitions) {
+        if (to.empty()) continue;
+
+        uint32_t q = idx(key.first);
+        while (row <= q) {
+            C.rowOffsets[row] = (uint32_t)C.edgeColumns.size();
+            C.epsOffsets[row] = (uint32_t)C.epsTargets.size();
+            row++;
+        }
+
+        if (key.second == '#') {
+            for (int t : to) C.epsTargets.push_back(idx(t));
+            continue;
+        }
+
+        C.edgeColumns.push_back((uint8_t)C.column(key.second));
+        for (int t : to) C.targets.push_back(idx(t));
+        C.targetOffsets.push_back((uint32_t)C.targets.size());
+    }
+
+    while (row <= n) {
+        C.rowOffsets[row] = (uint32_t)C.edgeColumns.size();
+        C.epsOffsets[row] = (uint32_t)C.epsTargets.size();
+        row++;
+    }
+
+    // --------------------------------------------------------------
+    // Step 4: Initial and final states.
+    // --------------------------------------------------------------
+    for (int s : A.initialStates) C.initialStates.push_back(idx(s));
+
+    C.finals.assign(n, 0);
+    for (int s : A.finalStates) C.finals[idx(s)] = 1;
+
+    return C;
+}
+
+/**
+ * @brief Converts the CSR form back into a map-based Automaton.
+ *
+ * Rows are emitted in (state, symbol) order — ε ('#') merged in at its
+ * character position — so the map is filled with end-hinted inserts.
+ */
+Automaton CSRAutomaton::toAutomaton() const {
+    Automaton A;
+    uint32_t n = size();
+
+    for (uint32_t q = 0; q < n; q++) {
+        A.states.insert(A.states.end(), stateIds[q]);
+        if (finals[q]) A.finalStates.insert(A.finalStates.end(), stateIds[q]);
+
+        auto emit = [&](char c, const uint32_t* first, const uint32_t* last) {
+            if (first == last) return;
+            auto it = A.transitions.emplace_hint(
+                A.transitions.end(), make_pair(stateIds[q], c), set<int>());
+            for (const uint32_t* t = first; t != last; ++t) {
+                it->second.insert(it->second.end(), stateIds[*t]);
+            }
+        };
+
+        bool epsDone = false;
+        for (uint32_t e = edgeBegin(q); e < edgeEnd(q); e++) {
+            char c = symbols[edgeColumns[e]];
+            if (!epsDone && c > '#') {
+                emit('#', epsilonBegin(q), epsilonEnd(q));
+                epsDone = true;
+            }
+            emit(c, targetsBegin(e), targetsEnd(e));
+        }
+        if (!epsDone) emit('#', epsilonBegin(q), epsilonEnd(q));
+    }
+
+    for (uint32_t q : initialStates) A.initialStates.insert(stateIds[q]);
+
+    A.alphabet = set<char>(alphabet.begin(), alphabet.end());
+
+    return A;
+}
+
+/**
+ * @brief Transposes the automaton in linear time.
+ *
+ * @details
+ * Every edge q --c--> t becomes t --c--> q.  The reversed edges must be
+ * grouped by (t, c) with sources sorted, which is exactly an LSD radix sort
+ * on (t, c, q):
+ *
+ *   - the forward walk already yields q in increasing order,
+ *   - a stable counting pass on c, then
+ *   - a stable counting pass on t.
+ *
+ * ε-edges are reversed with a single counting pass on t.
+ */
+CSRAutomaton CSRAutomaton::reverse() const {
+    CSRAutomaton R;
+    uint32_t n = size();
+    uint32_t k = alphabetSize();
+
+    R.stateIds = stateIds;
+    R.symbols  = symbols;
+    R.alphabet = alphabet;
+    R.indexSymbols();
+
+    // Initial ↔ final.
+    for (uint32_t q = 0; q < n; q++) {
+        if (finals[q]) R.initialStates.push_back(q);
+    }
+    R.finals.assign(n, 0);
+    for (uint32_t q : initialStates) R.finals[q] = 1;
+
+    // --------------------------------------------------------------
+    // Labelled edges: list (t, c, q) in q order, then radix sort.
+    // --------------------------------------------------------------
+    struct Rev { uint32_t t; uint32_t c; uint32_t q; };
+    vector<Rev> fwd;
+    fwd.reserve(targets.size());
+
+    for (uint32_t q = 0; q < n; q++) {
+        for (uint32_t e = edgeBegin(q); e < edgeEnd(q); e++) {
+            for (const uint32_t* t = targetsBegin(e); t != targetsEnd(e); ++t) {
+                fwd.push_back({*t, edgeColumns[e], q});
+            }
+        }
+    }
+
+    vector<Rev> byC(fwd.size());
+    {
+        vector<uint32_t> count(k + 1, 0);
+        for (auto& r : fwd) count[r.c + 1]++;
+        for (uint32_t c = 0; c < k; c++) count[c + 1] += count[c];
+        for (auto& r : fwd) byC[count[r.c]++] = r;
+    }
+
+    vector<Rev> byT(fwd.size());
+    {
+        vector<uint32_t> count(n + 1, 0);
+        for (auto& r : byC) count[r.t + 1]++;
+        for (uint32_t t = 0; t < n; t++) count[t + 1] += count[t];
+        for (auto& r : byC) byT[count[r.t]++] = r;
+    }
+
+    R.rowOffsets.assign(n + 1, 0);
+    R.targetOffsets.push_back(0);
+    R.targets.reserve(byT.size());
+
+    size_t i = 0;
+    for (uint32_t t = 0; t < n; t++) {
+        R.rowOffsets[t] = (uint32_t)R.edgeColumns.size();
+        while (i < byT.size() && byT[i].t == t) {
+            uint32_t c = byT[i].c;
+            while (i < byT.size() && byT[i].t == t && byT[i].c == c) {
+                R.targets.push_back(byT[i].q);
+                i++;
+            }
+            R.edgeColumns.push_back((uint8_t)c);
+            R.targetOffsets.push_back((uint32_t)R.targets.size());
+        }
+    }
+    R.rowOffsets[n] = (uint32_t)R.edgeColumns.size();
+
+    // --------------------------------------------------------------
+    // ε-edges.
+    // --------------------------------------------------------------
+    R.epsOffsets.assign(n + 1, 0);
+    for (uint32_t t : epsTargets) R.epsOffsets[t + 1]++;
+    for (uint32_t t = 0; t < n; t++) R.epsOffsets[t + 1] += R.epsOffsets[t];
+
+    R.epsTargets.resize(epsTargets.size());
+    vector<uint32_t> cursor(R.epsOffsets.begin(), R.epsOffsets.end() - 1);
+    for (uint32_t q = 0; q < n; q++) {
+        for (const uint32_t* t = epsilonBegin(q); t != epsilonEnd(q); ++t) {
+            R.epsTargets[cursor[*t]++] = q;
+        }
+    }
+
+    return R;
+}
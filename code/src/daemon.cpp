@@ -0,0 +1,754 @@
+#include "../include/Daemon.h"
+#include "../include/Automaton.h"
+#include "../include/AutomatonView.h"
+#include "../include/NFAToRegex.h"
+#include "../include/RegexParser.h"
+#include "../include/RegexUtils.h"
+#include "../include/ThreadPool.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Requests of one client queued or running at once; its further lines
+/// are read only as earlier responses are written.
+const size_t MAX_IN_FLIGHT = 64;
+
+/// Longest request line accepted (inline automata can be large).
+const size_t MAX_REQUEST_BYTES = size_t(64) << 20;
+
+// ------------------------------------------------------------------
+// JSON (flat objects only: the protocol never nests)
+// ------------------------------------------------------------------
+
+/**
+ * @brief Appends code point cp to out as UTF-8.
+ */
+void appendUtf8(string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+/**
+ * @brief Minimal reader for one flat JSON object.
+ *
+ * @details
+ * String values are stored unescaped; numbers, true, false and null are
+ * stored as their raw text.  rawId keeps the "id" value exactly as sent,
+ * so it can be echoed whatever its type.  Nested objects and arrays are
+ * rejected.
+ */
+class RequestParser {
+public:
+    explicit RequestParser(const string& text) : s(text) {}
+
+    void parse(map<string, string>& fields, string& rawId) {
+        skipSpace();
+        expect('{');
+        skipSpace();
+
+        if (peek() == '}') {
+            i++;
+        } else {
+            while (true) {
+                skipSpace();
+                string key = parseString();
+                skipSpace();
+                expect(':');
+                skipSpace();
+
+                size_t begin = i;
+                string value = (peek() == '"') ? parseString() : parseLiteral();
+                if (key == "id") rawId = s.substr(begin, i - begin);
+                fields[key] = value;
+
+                skipSpace();
+                if (peek() == ',') { i++; continue; }
+                expect('}');
+                break;
+            }
+        }
+
+        skipSpace();
+        if (i != s.size()) fail("trailing characters");
+    }
+
+private:
+    const string& s;
+    size_t i = 0;
+
+    [[noreturn]] void fail(const string& what) {
+        throw runtime_error("invalid JSON at offset " + to_string(i) + ": " + what);
+    }
+
+    char peek() const {
+        return i < s.size() ? s[i] : '\0';
+    }
+
+    void expect(char c) {
+        if (peek() != c) fail(string("expected '") + c + "'");
+        i++;
+    }
+
+    void skipSpace() {
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+    }
+
+    uint32_t parseHex4() {
+        if (i + 4 > s.size()) fail("truncated \\u escape");
+        uint32_t v = 0;
+        for (int k = 0; k < 4; k++) {
+            char c = s[i++];
+            v <<= 4;
+            if      (c >= '0' && c <= '9') v |= (uint32_t)(c - '0');
+            else if (c >= 'a' && c <= 'f') v |= (uint32_t)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') v |= (uint32_t)(c - 'A' + 10);
+            else fail("bad \\u escape");
+        }
+        return v;
+    }
+
+    string parseString() {
+        expect('"');
+        string out;
+
+        while (true) {
+            if (i >= s.size()) fail("unterminated string");
+            char c = s[i++];
+
+            if (c == '"') return out;
+            if (c != '\\') { out += c; continue; }
+
+            if (i >= s.size()) fail("unterminated string");
+            char e = s[i++];
+            switch (e) {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    uint32_t cp = parseHex4();
+                    if (cp >= 0xD800 && cp < 0xDC00 && s.compare(i, 2, "\\u") == 0) {
+                        i += 2;
+                        uint32_t lo = parseHex4();
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    fail("bad escape");
+            }
+        }
+    }
+
+    string parseLiteral() {
+        size_t begin = i;
+        while (i < s.size() && s[i] != ',' && s[i] != '}' &&
+               s[i] != ' ' && s[i] != '\t' && s[i] != '\r' && s[i] != '\n') {
+            if (s[i] == '{' || s[i] == '[' || s[i] == '"') fail("nested values are not supported");
+            i++;
+        }
+        if (begin == i) fail("missing value");
+        return s.substr(begin, i - begin);
+    }
+};
+
+/**
+ * @brief s as a quoted JSON string.
+ */
+string jsonString(const string& s) {
+    string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof buf, "\\u%04x", (unsigned)(unsigned char)c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+// ------------------------------------------------------------------
+// Warm caches
+// ------------------------------------------------------------------
+
+/**
+ * @brief Thread-safe least-recently-used map bounded both by entry count
+ *        and by bytes (keys plus the value sizes given to put()).
+ */
+template <class Value>
+class LruCache {
+public:
+    LruCache(size_t capacity, size_t byteBudget) : capacity(capacity), byteBudget(byteBudget) {}
+
+    bool get(const string& key, Value& out) {
+        lock_guard<mutex> guard(lock);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        out = it->second->value;
+        hits++;
+        return true;
+    }
+
+    /// Stores value, estimated at valueBytes; not cached if it alone
+    /// exceeds the byte budget.
+    void put(const string& key, const Value& value, size_t valueBytes) {
+        size_t entryBytes = 2 * key.size() + valueBytes + ENTRY_OVERHEAD;
+
+        lock_guard<mutex> guard(lock);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            bytes -= it->second->bytes;
+            index.erase(it->second->key);
+            entries.erase(it->second);
+        }
+        if (entryBytes > byteBudget) return;
+
+        entries.push_front({ key, value, entryBytes });
+        index[key] = entries.begin();
+        bytes += entryBytes;
+
+        while (entries.size() > capacity || bytes > byteBudget) {
+            bytes -= entries.back().bytes;
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+    /// {"size":…,"bytes":…,"hits":…,"misses":…}
+    string statsJson() {
+        lock_guard<mutex> guard(lock);
+        return "{\"size\":" + to_string(entries.size()) + ",\"bytes\":" + to_string(bytes) +
+               ",\"hits\":" + to_string(hits) + ",\"misses\":" + to_string(misses) + "}";
+    }
+
+private:
+    /// List node, index node and bookkeeping of one entry, roughly.
+    static constexpr size_t ENTRY_OVERHEAD = 128;
+
+    struct Entry {
+        string key;
+        Value value;
+        size_t bytes;
+    };
+
+    size_t capacity;
+    size_t byteBudget;
+    size_t bytes = 0;
+    mutex lock;
+    list<Entry> entries;    ///< Most recently used first
+    unordered_map<string, typename list<Entry>::iterator> index;
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+/**
+ * @brief Fixed-size cache key for arbitrarily long text: two independent
+ *        64-bit hashes and the length, so large request fields are not
+ *        kept in memory as keys.
+ */
+string contentKey(const string& text) {
+    uint64_t fnv = 1469598103934665603ull;
+    for (unsigned char c : text) {
+        fnv = (fnv ^ c) * 1099511628211ull;
+    }
+
+    char buf[64];
+    snprintf(buf, sizeof buf, "%016llx%016llx:%zu",
+             (unsigned long long)fnv, (unsigned long long)hash<string>()(text), text.size());
+    return buf;
+}
+
+/**
+ * @brief Rough heap footprint of A: the nodes of its sets and transition
+ *        map, plus its frozen CSR arrays.
+ */
+size_t estimatedBytes(const Automaton& A) {
+    const size_t SET_NODE = 40, MAP_NODE = 96;
+
+    size_t targets = 0;
+    for (auto& entry : A.getTransitions()) targets += entry.second.size();
+
+    size_t n = A.getStates().size(), edges = A.getTransitions().size();
+    size_t nodes = n + A.getInitialStates().size() + A.getFinalStates().size() +
+                   A.getAlphabet().size();
+
+    return sizeof(Automaton) + SET_NODE * (nodes + targets) + MAP_NODE * edges +
+           16 * n + 9 * edges + 8 * targets;      // CSR
+}
+
+/**
+ * @brief A parsed automaton, frozen once so concurrent readers share the
+ *        CSR form; for files, the size and time it was read at.
+ */
+struct CachedAutomaton {
+    shared_ptr<const Automaton> automaton;
+    filesystem::file_time_type stamp;
+    uintmax_t size = 0;
+};
+
+/**
+ * @brief Request dispatcher shared by all connections.
+ */
+class Server {
+public:
+    Server(size_t cacheEntries, size_t cacheBytes)
+        : automata(cacheEntries, cacheBytes), results(cacheEntries, cacheBytes) {}
+
+    /// Response line (without '\n') for one request line.
+    string handle(const string& line) {
+        map<string, string> fields;
+        string rawId = "null";
+
+        try {
+            RequestParser(line).parse(fields, rawId);
+            return "{\"id\":" + rawId + ",\"ok\":true,\"result\":" + dispatch(fields) + "}";
+        } catch (const exception& e) {
+            return "{\"id\":" + rawId + ",\"ok\":false,\"error\":" + jsonString(e.what()) + "}";
+        }
+    }
+
+private:
+    LruCache<CachedAutomaton> automata;
+    LruCache<string> results;
+
+    static const string& field(const map<string, string>& f, const string& key) {
+        auto it = f.find(key);
+        if (it == f.end()) throw runtime_error("missing field \"" + key + "\"");
+        return it->second;
+    }
+
+    static string optional(const map<string, string>& f, const string& key, const string& fallback) {
+        auto it = f.find(key);
+        return it == f.end() ? fallback : it->second;
+    }
+
+    static MinimizationAlgorithm algorithmOf(const string& name) {
+        if (name == "moore")    return MinimizationAlgorithm::Moore;
+        if (name == "hopcroft") return MinimizationAlgorithm::Hopcroft;
+        if (name == "valmari")  return MinimizationAlgorithm::ValmariLehtinen;
+        throw runtime_error("unknown algo \"" + name + "\"");
+    }
+
+    static RegexConstruction constructionOf(const string& name) {
+        if (name == "thompson")    return RegexConstruction::Thompson;
+        if (name == "glushkov")    return RegexConstruction::Glushkov;
+        if (name == "antimirov")   return RegexConstruction::Antimirov;
+        if (name == "derivatives") return RegexConstruction::Derivatives;
+        throw runtime_error("unknown construction \"" + name + "\"");
+    }
+
+    static string automatonJson(const Automaton& A) {
+        ostringstream out;
+        A.writeAutomaton(out);
+        return jsonString(out.str());
+    }
+
+    /**
+     * @brief Parses automaton text, throwing on the first malformed line
+     *        (source names the input in the message).
+     */
+    static Automaton parseOrThrow(const string& text, const string& source) {
+        vector<Automaton::ParseError> errors;
+        Automaton A = Automaton::parseAutomaton(text, &errors);
+        if (errors.empty()) return A;
+
+        string message = source + ":" + to_string(errors[0].line) + ": " + errors[0].message;
+        if (errors.size() > 1) message += " (and " + to_string(errors.size() - 1) + " more malformed line(s))";
+        throw runtime_error(message);
+    }
+
+    /**
+     * @brief The automaton given inline (textKey) or by path (fileKey),
+     *        from the cache when possible.
+     *
+     * Malformed text and unreadable or corrupt files throw, so they are
+     * answered with "ok":false and never cached.
+     */
+    shared_ptr<const Automaton> loadAutomaton(const map<string, string>& f,
+                                              const string& textKey, const string& fileKey) {
+        CachedAutomaton entry;
+
+        auto text = f.find(textKey);
+        if (text != f.end()) {
+            string key = "text:" + contentKey(text->second);
+            if (automata.get(key, entry)) return entry.automaton;
+
+            entry.automaton = make_shared<const Automaton>(parseOrThrow(text->second, textKey));
+            entry.automaton->freeze();
+            automata.put(key, entry, estimatedBytes(*entry.automaton));
+            return entry.automaton;
+        }
+
+        const string& path = field(f, fileKey);
+        error_code ec;
+        auto stamp = filesystem::last_write_time(path, ec);
+        uintmax_t size = ec ? 0 : filesystem::file_size(path, ec);
+        if (ec) throw runtime_error("cannot read " + path + ": " + ec.message());
+
+        string key = "file:" + path;
+        if (automata.get(key, entry) && entry.stamp == stamp && entry.size == size) {
+            return entry.automaton;
+        }
+
+        if (filesystem::path(path).extension() == ".mtpa") {
+            string error;
+            Automaton A = readBinaryAutomaton(path, &error);
+            if (!error.empty()) throw runtime_error(error);
+            entry.automaton = make_shared<const Automaton>(std::move(A));
+        } else {
+            ifstream fin(path, ios::binary);
+            if (!fin.is_open()) throw runtime_error("cannot open " + path);
+
+            string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+            if (fin.bad()) throw runtime_error("cannot read " + path);
+            entry.automaton = make_shared<const Automaton>(parseOrThrow(text, path));
+        }
+        entry.automaton->freeze();
+        entry.stamp = stamp;
+        entry.size = size;
+        automata.put(key, entry, estimatedBytes(*entry.automaton));
+        return entry.automaton;
+    }
+
+    /// JSON value of the result of one request.
+    string dispatch(const map<string, string>& f) {
+        const string& op = field(f, "op");
+
+        if (op == "ping") return jsonString("pong");
+
+        if (op == "stats") {
+            return "{\"automata\":" + automata.statsJson() +
+                   ",\"results\":" + results.statsJson() + "}";
+        }
+
+        if (op == "determinise") {
+            return automatonJson(Automaton::determinise(*loadAutomaton(f, "automaton", "file")));
+        }
+
+        if (op == "minimize") {
+            MinimizationAlgorithm algorithm = algorithmOf(optional(f, "algo", "hopcroft"));
+            bool complete = algorithm != MinimizationAlgorithm::ValmariLehtinen;
+
+            auto A = loadAutomaton(f, "automaton", "file");
+            return automatonJson(Automaton::minimize(Automaton::determinise(*A, complete), algorithm));
+        }
+
+        if (op == "brzozowski") {
+            auto A = loadAutomaton(f, "automaton", "file");
+            Automaton det1 = Automaton::determinise(Automaton::reverseTransitions(*A));
+            return automatonJson(Automaton::determinise(Automaton::reverseTransitions(det1)));
+        }
+
+        if (op == "isomorphic") {
+            auto A = loadAutomaton(f, "automaton", "file");
+            auto B = loadAutomaton(f, "automaton2", "file2");
+            return Automaton::isIsomorphic(*A, *B, nullptr) ? "true" : "false";
+        }
+
+        if (op == "minimize-regex" || op == "standardize-regex") {
+            const string& regex = field(f, "regex");
+            string name = optional(f, "construction", "glushkov");
+            RegexConstruction construction = constructionOf(name);
+
+            string key = op + '\0' + name + '\0' + contentKey(regex);
+            string result;
+            if (results.get(key, result)) return result;
+
+            if (op == "minimize-regex") {
+                result = jsonString(minimizeRegex(regex, construction));
+            } else {
+                // As standardizeRegex: minimal DFA, then state elimination.
+                Automaton A = regexToAutomaton(parseRegexToAST(regex), construction);
+                Automaton minDFA = Automaton::minimize(Automaton::determinise(A));
+                result = jsonString(automatonToRegex(minDFA));
+            }
+
+            results.put(key, result, result.size());
+            return result;
+        }
+
+        throw runtime_error("unknown op \"" + op + "\"");
+    }
+};
+
+// ------------------------------------------------------------------
+// Transport
+// ------------------------------------------------------------------
+
+/**
+ * @brief Output side of one client: a writer thread of its own drains a
+ *        bounded outbox, so pool workers never block on a slow client.
+ *
+ * @details
+ * The reader calls acquire() before queueing each request, which blocks
+ * while MAX_IN_FLIGHT requests of this client are queued, running or
+ * waiting in the outbox.  A worker only appends its response (post()),
+ * and the slot is released once the writer has sent it.  A client that
+ * stops reading thus stalls its own writer and reader, nothing else.
+ * Owned descriptors are closed when the connection is destroyed.
+ */
+class Connection {
+public:
+    Connection(int fd, bool owned) : fd(fd), owned(owned) {
+        writer = thread([this] { writerLoop(); });
+    }
+
+    ~Connection() {
+        if (writer.joinable()) finish();
+        if (owned) close(fd);
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// Waits for a free in-flight slot.
+    void acquire() {
+        unique_lock<mutex> guard(lock);
+        changed.wait(guard, [&] { return inFlight < MAX_IN_FLIGHT; });
+        inFlight++;
+    }
+
+    /// Queues the response of an acquired request; never blocks on I/O.
+    void post(string line) {
+        lock_guard<mutex> guard(lock);
+        outbox.push_back(std::move(line));
+        changed.notify_all();
+    }
+
+    /// Called by the reader at EOF: sends what is in flight, then stops.
+    void finish() {
+        {
+            lock_guard<mutex> guard(lock);
+            closing = true;
+            changed.notify_all();
+        }
+        writer.join();
+    }
+
+private:
+    int fd;
+    bool owned;
+    bool broken = false;        ///< Client gone: responses are dropped
+
+    mutex lock;
+    condition_variable changed;
+    deque<string> outbox;
+    size_t inFlight = 0;
+    bool closing = false;
+    thread writer;
+
+    void writerLoop() {
+        unique_lock<mutex> guard(lock);
+
+        while (true) {
+            changed.wait(guard, [&] { return !outbox.empty() || (closing && inFlight == 0); });
+            if (outbox.empty()) return;
+
+            string line = std::move(outbox.front());
+            outbox.pop_front();
+
+            guard.unlock();
+            if (!broken) broken = !writeAll(line);
+            guard.lock();
+
+            inFlight--;
+            changed.notify_all();
+        }
+    }
+
+    bool writeAll(const string& line) {
+        size_t done = 0;
+        while (done < line.size()) {
+            ssize_t n = write(fd, line.data() + done, line.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += (size_t)n;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Queues one request line on the pool once the connection has a
+ *        free in-flight slot.
+ */
+void submitLine(string line, const shared_ptr<Connection>& out, Server& server, ThreadPool& pool) {
+    out->acquire();
+    pool.submit([line = std::move(line), out, &server] {
+        out->post(server.handle(line) + "\n");
+    });
+}
+
+/**
+ * @brief Reads request lines from inFd until EOF and queues each one on
+ *        the pool; the responses go to out, which is finished (drained)
+ *        before returning.
+ *
+ * A line longer than MAX_REQUEST_BYTES is answered with an error and
+ * ends the stream.
+ */
+void serveStream(int inFd, const shared_ptr<Connection>& out, Server& server, ThreadPool& pool) {
+    string pending;
+    char buffer[1 << 16];
+
+    while (true) {
+        ssize_t n = read(inFd, buffer, sizeof buffer);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        pending.append(buffer, (size_t)n);
+
+        size_t start = 0, newline;
+        while ((newline = pending.find('\n', start)) != string::npos) {
+            string line = pending.substr(start, newline - start);
+            start = newline + 1;
+
+            if (line.find_first_not_of(" \t\r") == string::npos) continue;
+            submitLine(std::move(line), out, server, pool);
+        }
+        pending.erase(0, start);
+
+        if (pending.size() > MAX_REQUEST_BYTES) {
+            out->acquire();
+            out->post("{\"id\":null,\"ok\":false,\"error\":\"request line longer than " +
+                      to_string(MAX_REQUEST_BYTES) + " bytes\"}\n");
+            pending.clear();
+            break;
+        }
+    }
+
+    if (pending.find_first_not_of(" \t\r") != string::npos) {
+        submitLine(std::move(pending), out, server, pool);
+    }
+    out->finish();
+}
+
+} // namespace
+
+/**
+ * @brief Server main loop (see Daemon.h).
+ *
+ * @details
+ * 1. stdin mode: one stream, answered on stdout; at EOF serveStream()
+ *    waits until every response is written.
+ * 2. Socket mode: bind and listen on the Unix socket (a stale socket file
+ *    is replaced), then give every accepted client a reader thread of its
+ *    own (and a writer, see Connection).  The readers only split lines;
+ *    all work runs on the pool.  This loop does not return: the server
+ *    runs until it is killed.
+ */
+int runDaemon(const DaemonOptions& options) {
+    // A client that disconnects early must not kill the server.
+    signal(SIGPIPE, SIG_IGN);
+
+    Server server(options.cacheEntries, options.cacheBytes);
+    ThreadPool pool(options.jobs);
+
+    // ------ Step 1: stdin / stdout
+    if (options.socketPath.empty()) {
+        auto out = make_shared<Connection>(STDOUT_FILENO, false);
+        serveStream(STDIN_FILENO, out, server, pool);
+        pool.waitAll();
+        return 0;
+    }
+
+    // ------ Step 2: Unix domain socket
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof address.sun_path) {
+        cerr << "Socket path too long: " << options.socketPath << "\n";
+        return 1;
+    }
+    strcpy(address.sun_path, options.socketPath.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        cerr << "socket: " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    unlink(options.socketPath.c_str());
+    if (bind(listener, (sockaddr*)&address, sizeof address) < 0 || listen(listener, 64) < 0) {
+        cerr << "Cannot listen on " << options.socketPath << ": " << strerror(errno) << "\n";
+        close(listener);
+        return 1;
+    }
+
+    cerr << "Listening on " << options.socketPath << " with " << pool.size() << " worker(s)\n";
+
+    while (true) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            // Out of descriptors and the like: back off and keep serving.
+            if (errno != EINTR && errno != ECONNABORTED) {
+                cerr << "accept: " << strerror(errno) << "\n";
+                this_thread::sleep_for(chrono::milliseconds(100));
+            }
+            continue;
+        }
+
+        auto out = make_shared<Connection>(client, true);
+        thread([client, out, &server, &pool] {
+            serveStream(client, out, server, pool);
+        }).detach();
+    }
+}
@@ -0,0 +1,209 @@
+#include "../include/DenseDFA.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * @brief Creates an n-state DFA whose every transition is NONE.
+ *
+ * State i keeps i as its Automaton id, and the declared alphabet defaults
+ * to all columns except '#'.
+ */
+DenseDFA::DenseDFA(uint32_t n, const string& cols)
+    : numStates(n),
+      symbols(cols),
+      table((size_t)n * cols.size(), NONE),
+      finals(n, 0),
+      stateIds(n) {
+
+    for (uint32_t i = 0; i < n; i++) {
+        stateIds[i] = (int)i;
+    }
+
+    for (char c : symbols) {
+        if (c != '#') alphabet += c;
+    }
+
+    indexSymbols();
+}
+
+/**
+ * @brief Rebuilds the symbol → column lookup table.
+ */
+void DenseDFA::indexSymbols() {
+    fill(begin(columnOf), end(columnOf), -1);
+    for (size_t i = 0; i < symbols.size(); i++) {
+        columnOf[(unsigned char)symbols[i]] = (int)i;
+    }
+}
+
+/**
+ * @brief Appends one state (row) with all transitions undefined.
+ *
+ * @return Index of the new state.
+ */
+uint32_t DenseDFA::addState() {
+    table.resize(table.size() + symbols.size(), NONE);
+    finals.push_back(0);
+    stateIds.push_back((int)numStates);
+    return numStates++;
+}
+
+/**
+ * @brief Returns true if every (state, column) entry is defined.
+ */
+bool DenseDFA::isComplete() const {
+    return find(table.begin(), table.end(), NONE) == table.end();
+}
+
+/**
+ * @brief Converts a deterministic Automaton into a DenseDFA.
+ *
+ * @details
+ * 1. Collect every state id mentioned anywhere (states, transitions,
+ *    initial, final) and sort them; dense index = rank.
+ * 2. Columns = declared alphabet ∪ transition symbols, sorted.
+ * 3. Fill the table row by row.  The transition map is ordered by
+ *    (from, symbol), so each source is located only once.
+ *
+ * When the ids are already 0 .. n-1 (the common case for automata produced
+ * by this project), the rank lookup is the identity.
+ *
+ * @param A Deterministic automaton.
+ * @return  Equivalent dense DFA.
+ */
+DenseDFA DenseDFA::fromAutomaton(const Automaton& A) {
+
+    // --------------------------------------------------------------
+    // Step 1: Compact state ids.
+    // --------------------------------------------------------------
+    vector<int> ids(A.states.begin(), A.states.end());
+    bool extra = false;
+
+    auto mention = [&](int s) {
+        if (!A.states.count(s)) {
+            ids.push_back(s);
+            extra = true;
+        }
+    };
+
+    for (auto& [key, targets] : A.transitions) {
+        mention(key.first);
+        for (int t : targets) mention(t);
+    }
+    for (int s : A.initialStates) mention(s);
+    for (int s : A.finalStates)   mention(s);
+
+    if (extra) {
+        sort(ids.begin(), ids.end());
+        ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    bool identity = ids.empty() ||
+                    (ids.front() == 0 && ids.back() == (int)ids.size() - 1);
+
+    auto indexOf = [&](int s) -> uint32_t {
+        if (identity) return (uint32_t)s;
+        return (uint32_t)(lower_bound(ids.begin(), ids.end(), s) - ids.begin());
+    };
+
+    // --------------------------------------------------------------
+    // Step 2: Columns.
+    // --------------------------------------------------------------
+    string cols(A.alphabet.begin(), A.alphabet.end());
+    for (auto& [key, targets] : A.transitions) {
+        if (!A.alphabet.count(key.second) &&
+            cols.find(key.second) == string::npos) {
+            cols += key.second;
+        }
+    }
+    sort(cols.begin(), cols.end());
+
+    DenseDFA D((uint32_t)ids.size(), cols);
+    D.stateIds = ids;
+    D.alphabet.assign(A.alphabet.begin(), A.alphabet.end());
+
+    // --------------------------------------------------------------
+    // Step 3: Transitions, initial and final states.
+    // --------------------------------------------------------------
+    bool deterministic = A.initialStates.size() <= 1;
+
+    int lastFrom = 0;
+    uint32_t row = NONE;
+
+    for (auto& [key, targets] : A.transitions) {
+        if (targets.empty()) continue;
+
+        if (row == NONE || key.first != lastFrom) {
+            lastFrom = key.first;
+            row = indexOf(key.first);
+        }
+
+        if (targets.size() > 1) deterministic = false;
+
+        D.setNext(row, (uint32_t)D.column(key.second), indexOf(*targets.begin()));
+    }
+
+    if (!A.initialStates.empty()) {
+        D.initial = indexOf(*A.initialStates.begin());
+    }
+
+    for (int s : A.finalStates) {
+        D.finals[indexOf(s)] = 1;
+    }
+
+    if (!deterministic) {
+        cerr << "[ERROR] DenseDFA: automaton is not deterministic; "
+             << "keeping the smallest target of each transition\n";
+    }
+
+    return D;
+}
+
+/**
+ * @brief Converts the dense table back into a map-based Automaton.
+ *
+ * Rows are emitted in order, so when state ids are increasing the map is
+ * filled with end-hinted inserts and no tree search is needed.
+ */
+Automaton DenseDFA::toAutomaton() const {
+    Automaton A;
+    size_t k = symbols.size();
+
+    // Columns sorted by symbol so that (from, symbol) keys come out ordered.
+    vector<uint32_t> order(k);
+    for (size_t c = 0; c < k; c++) order[c] = (uint32_t)c;
+    sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+        return symbols[x] < symbols[y];
+    });
+
+    for (uint32_t s = 0; s < numStates; s++) {
+        A.states.insert(A.states.end(), stateIds[s]);
+
+        if (finals[s]) {
+            A.finalStates.insert(A.finalStates.end(), stateIds[s]);
+        }
+
+        const uint32_t* rowPtr = table.data() + (size_t)s * k;
+        for (uint32_t c : order) {
+            uint32_t t = rowPtr[c];
+            if (t == NONE) continue;
+
+            auto it = A.transitions.emplace_hint(
+                A.transitions.end(),
+                make_pair(stateIds[s], symbols[c]),
+                set<int>());
+            it->second.insert(stateIds[t]);
+        }
+    }
+
+    if (initial != NONE) {
+        A.initialStates.insert(stateIds[initial]);
+    }
+
+    A.alphabet = set<char>(alphabet.begin(), alphabet.end());
+
+    return A;
+}
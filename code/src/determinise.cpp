@@ -1,9 +1,187 @@
 #include "../include/Automaton.h"
+#include "../include/CSRAutomaton.h"
+#include "../include/DenseDFA.h"
+#include "../include/EpsilonClosure.h"
+#include "../include/StateSet.h"
+#include "../include/SubsetTable.h"
+#include "../include/ThreadPool.h"
 
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 using namespace std;
 
+/**
+ * @brief Successor computation shared by the sequential and parallel
+ *        subset constructions.
+ *
+ * @details
+ * Holds the read-only, per-NFA precomputation:
+ *
+ *   - finalMask:  bitset of final NFA states;
+ *   - closure:    ε-closures of all states, if the NFA has ε-edges;
+ *   - masks:      target bitset of every edge with at least as many
+ *                 targets as mask words (ε-closed if there are ε-edges).
+ *                 Shorter target lists are cheaper to apply one by one,
+ *                 so no mask is stored for them.
+ *
+ * With ε-edges every subset is kept ε-closed, so the subset construction
+ * goes from an ε-NFA straight to a DFA without a separate ε-removal pass.
+ *
+ * The stepper is read-only after construction and is safe to share
+ * between threads; the mutable accumulators live in a per-thread Scratch.
+ */
+struct SubsetStepper {
+    const CSRAutomaton& N;
+    StateSet finalMask;
+    unique_ptr<EpsilonClosure> closure;    ///< Null if N has no ε-edges
+    vector<uint32_t> maskOf;    ///< Edge → index into masks, or NONE
+    vector<StateSet> masks;
+
+    /// Per-thread accumulators: one successor per column, and the columns
+    /// touched by the current subset.
+    struct Scratch {
+        vector<StateSet> nextSet;
+        vector<uint8_t> isTouched;
+        vector<uint32_t> touched;
+        StateSet current;
+    };
+
+    explicit SubsetStepper(const CSRAutomaton& nfa)
+        : N(nfa), finalMask(nfa.size()), maskOf(nfa.numEdges(), DenseDFA::NONE) {
+        uint32_t n = N.size();
+
+        for (uint32_t s = 0; s < n; s++) {
+            if (N.isFinal(s)) finalMask.insert(s);
+        }
+
+        if (N.hasEpsilon()) closure = make_unique<EpsilonClosure>(N);
+
+        uint32_t maskWords = (n + 63) / 64;
+        for (uint32_t e = 0; e < N.numEdges(); e++) {
+            if ((uint32_t)(N.targetsEnd(e) - N.targetsBegin(e)) < maskWords) continue;
+
+            maskOf[e] = (uint32_t)masks.size();
+            masks.emplace_back(n);
+            for (const uint32_t* t = N.targetsBegin(e); t != N.targetsEnd(e); ++t) {
+                add(*t, masks.back());
+            }
+        }
+    }
+
+    /// S ∪= ε-closure(q) (just q without ε-edges).
+    void add(uint32_t q, StateSet& S) const {
+        if (closure) {
+            closure->addTo(q, S);
+        } else {
+            S.insert(q);
+        }
+    }
+
+    /// The initial subset: ε-closure of the initial states.
+    StateSet start() const {
+        StateSet S(N.size());
+        for (uint32_t s : N.getInitialStates()) add(s, S);
+        return S;
+    }
+
+    Scratch makeScratch() const {
+        Scratch sc;
+        sc.nextSet.assign(N.alphabetSize(), StateSet(N.size()));
+        sc.isTouched.assign(N.alphabetSize(), 0);
+        sc.current = StateSet(N.size());
+        return sc;
+    }
+
+    /**
+     * @brief Calls emit(col, δ_D(S, symbols[col])) for every column with at
+     *        least one edge out of S = sc.current, in increasing column
+     *        order.
+     *
+     * δ_D(S, a) is the OR of the (ε-closed) target masks of S's a-edges;
+     * symbols with no edge are never visited.
+     */
+    template <class Emit>
+    void step(Scratch& sc, Emit emit) const {
+        sc.touched.clear();
+
+        sc.current.forEach([&](uint32_t state) {
+            for (uint32_t e = N.edgeBegin(state); e < N.edgeEnd(state); e++) {
+                uint32_t col = N.edgeColumn(e);
+                StateSet& target = sc.nextSet[col];
+
+                if (!sc.isTouched[col]) {
+                    sc.isTouched[col] = 1;
+                    sc.touched.push_back(col);
+                }
+
+                if (maskOf[e] != DenseDFA::NONE) {
+                    target.unionWith(masks[maskOf[e]]);
+                } else {
+                    for (const uint32_t* t = N.targetsBegin(e); t != N.targetsEnd(e); ++t) {
+                        add(*t, target);
+                    }
+                }
+            }
+        });
+        sort(sc.touched.begin(), sc.touched.end());
+
+        for (uint32_t col : sc.touched) {
+            emit(col, sc.nextSet[col]);
+            sc.nextSet[col].clear();
+            sc.isTouched[col] = 0;
+        }
+    }
+};
+
+/**
+ * @brief Steps 3–4 of the subset construction: optional dead-state
+ *        completion, alphabet, and conversion back to an Automaton.
+ *
+ * @param D         DFA built so far (rows = discovered subsets).
+ * @param used      used[col] ⇔ some DFA edge is labelled with column col.
+ * @param complete  Whether to add the dead state.
+ */
+static Automaton finishDFA(DenseDFA& D, const vector<bool>& used, bool complete) {
+    const string symbols = D.getSymbols();
+    uint32_t k = D.alphabetSize();
+
+    // Step 3: Add a dead (sink) state to make the DFA total (complete).
+    // -----------------------------------------------------------------
+    // This ensures every state has a transition for every symbol.
+    uint32_t numStates = D.size();
+    uint32_t deadState = DenseDFA::NONE;
+
+    for (uint32_t s = 0; complete && s < numStates; s++) {
+        for (uint32_t col = 0; col < k; col++) {
+            // If a transition is missing, send it to the dead state.
+            if (used[col] && D.next(s, col) == DenseDFA::NONE) {
+                if (deadState == DenseDFA::NONE) deadState = D.addState();
+                D.setNext(s, col, deadState);
+            }
+        }
+    }
+
+    // If the dead state was used, add self-loops on all symbols.
+    if (deadState != DenseDFA::NONE) {
+        for (uint32_t col = 0; col < k; col++) {
+            if (used[col]) D.setNext(deadState, col, deadState);
+        }
+    }
+
+    // The DFA alphabet consists of the symbols that actually occur.
+    string alphabetUsed;
+    for (uint32_t col = 0; col < k; col++) {
+        if (used[col]) alphabetUsed += symbols[col];
+    }
+    D.setAlphabet(alphabetUsed);
+
+    // Step 4: Return the constructed deterministic automaton.
+    return D.toAutomaton();
+}
+
 /**
  * @brief Converts a Non-Deterministic Finite Automaton (NFA) into
  *        an equivalent Deterministic Finite Automaton (DFA) using
@@ -15,110 +193,260 @@ using namespace std;
  * the subset construction builds a DFA `D = (Q_D, Σ, δ_D, I_D, F_D)` such that:
  *
  * - Each DFA state corresponds to a *set of NFA states*.
- * - The initial state of `D` is the set of all initial states of `A`.
+ * - The initial state of `D` is ε-closure(I_A).
  * - A DFA state `S ⊆ Q_A` is *final* if `S ∩ F_A ≠ ∅`.
  * - The transition function δ_D is defined as:
- *      δ_D(S, a) = ⋃_{q ∈ S} δ_A(q, a)
+ *      δ_D(S, a) = ε-closure(⋃_{q ∈ S} δ_A(q, a))
  *
  * This guarantees that the DFA recognizes exactly the same language
  * as the NFA — that is, `L(D) = L(A)`.
  *
- * @param A  The input automaton (can be NFA or ε-NFA without explicit ε-handling here).
- * @return   A deterministic automaton equivalent to `A`.
+ * @param A         The input automaton: NFA or ε-NFA ('#' = ε).
+ * @param complete  Whether to add the dead state of Step 3.
+ * @return          A deterministic automaton equivalent to `A`.
  *
  * @note
- * - This implementation does **not** handle ε-transitions (ε-NFA).
- *   Those should be eliminated first using ε-closure computation.
- * - A "dead" (sink) state is added if necessary to make the resulting DFA complete.
+ * - ε-transitions are handled in the same pass: subsets are ε-closed with
+ *   the precomputed closures of EpsilonClosure, so an ε-NFA needs no
+ *   eNFAtoNFA() first (that would be a second subset construction).
+ * - A "dead" (sink) state is added if necessary to make the resulting DFA
+ *   complete, unless `complete` is false (partial DFA, for minimizers that
+ *   work on partial transition functions).
+ * - The NFA is read through its frozen CSR form: successors of a subset are
+ *   gathered from the edges that actually exist (no per-symbol map lookups).
+ * - Subsets are StateSet bitsets, so a successor is the word-parallel OR of
+ *   per-edge target masks and finality is a single AND with the final mask.
+ * - Discovered subsets are interned in a SubsetTable (open addressing on a
+ *   64-bit fingerprint, subsets stored in one contiguous arena).
+ * - The DFA is built directly into a DenseDFA table (one row per discovered
+ *   subset) and converted to an Automaton only once at the end.
  */
-Automaton Automaton::determinise(const Automaton& A) {
-    Automaton D;                       // Resulting deterministic automaton
-    map<set<int>, int> stateMapping;   // Maps subsets of NFA states → DFA state IDs
-    queue<set<int>> q;                 // Work queue for unprocessed subsets
+Automaton Automaton::determinise(const Automaton& A, bool complete) {
+    const CSRAutomaton& N = A.freeze();
+    uint32_t n = N.size();
+
+    DenseDFA D(0, N.getSymbols());              // Resulting deterministic automaton
+    vector<bool> used(N.alphabetSize(), false); // Symbols that label at least one DFA edge
+    SubsetTable stateMapping(n);                // Maps subsets of NFA states → DFA state IDs
 
-    int nextStateId = 0;               // Counter for assigning DFA state IDs
+    // Step 0: Precompute final and per-edge target masks.
+    SubsetStepper stepper(N);
+    SubsetStepper::Scratch sc = stepper.makeScratch();
 
     // Step 1: Initialize the DFA start state.
     // ---------------------------------------
-    // In subset construction, the initial DFA state is the set of all initial NFA states.
-    set<int> start = A.initialStates;
+    // In subset construction, the initial DFA state is the ε-closure of
+    // the set of all initial NFA states.
+    StateSet start = stepper.start();
 
-    q.push(start);                     // Queue starts with the initial subset
-    stateMapping[start] = nextStateId++;  // Assign DFA ID 0 to this subset
+    auto intern = [&](const StateSet& subset) -> uint32_t {
+        bool inserted;
+        uint32_t id = stateMapping.intern(subset, inserted);
+        if (inserted) D.addState();
+        return id;
+    };
 
-    D.initialStates.insert(0);         // DFA’s initial state is 0
+    intern(start);                              // Assign DFA ID 0 to this subset
+    D.setInitial(0);                            // DFA’s initial state is 0
 
     // Step 2: Process each subset (BFS traversal of subset space).
     // -------------------------------------------------------------
-    while (!q.empty()) {
-        set<int> current = q.front();
-        q.pop();
-
-        int currentId = stateMapping[current];
-        D.states.insert(currentId);
+    // DFA IDs are handed out in discovery order, so walking them in order
+    // is the BFS queue.
+    for (uint32_t currentId = 0; currentId < stateMapping.size(); currentId++) {
+        stateMapping.load(currentId, sc.current);
 
         // Step 2a: Mark current DFA state as final if any NFA state in it is final.
-        for (int state : current) {
-            if (A.finalStates.count(state)) {
-                D.finalStates.insert(currentId);
-                break;
-            }
-        }
+        if (sc.current.intersects(stepper.finalMask)) D.setFinal(currentId);
+
+        // Step 2b: For each symbol, the new subset reached by reading it.
+        stepper.step(sc, [&](uint32_t col, const StateSet& nextSet) {
+            // If this new subset of NFA states hasn’t been seen before,
+            // assign it a new DFA state ID (which also enqueues it).
+            // Create the DFA transition: currentId --c--> stateMapping[nextSet]
+            D.setNext(currentId, col, intern(nextSet));
+
+            // Ensure the symbol is included in the DFA’s alphabet.
+            used[col] = true;
+        });
+    }
+
+    return finishDFA(D, used, complete);
+}
+
+/**
+ * @brief Subset construction with every BFS level expanded in parallel.
+ *
+ * @details
+ * The subsets of one BFS level (the frontier) are independent: each
+ * worker loads a frontier subset, computes its successors with the shared
+ * SubsetStepper, and interns them in a sharded table.
+ *
+ *   - The shard is chosen by the top bits of the subset fingerprint; each
+ *     shard is a SubsetTable behind its own mutex, so workers only contend
+ *     when they hit the same shard at the same moment.
+ *   - Global DFA ids come from one atomic counter, so they depend on thread
+ *     timing.  Newly discovered subsets form the next frontier.
+ *   - Edges and final states are collected per worker and assembled into
+ *     a DenseDFA after the last level.
+ *
+ * With canonicalNumbering the DFA is finally renumbered by a BFS from the
+ * start state visiting symbols in column order.  That is exactly the order
+ * in which the sequential construction hands out ids, so the result is
+ * identical to determinise(A, complete).
+ *
+ * @param A                  The input NFA.
+ * @param numThreads         Worker threads; 0 = hardware concurrency.
+ * @param complete           Whether to add the dead state.
+ * @param canonicalNumbering Renumber to match the sequential result.
+ * @return                   A deterministic automaton equivalent to `A`.
+ */
+Automaton Automaton::determiniseParallel(const Automaton& A, unsigned numThreads,
+                                         bool complete, bool canonicalNumbering) {
+    const CSRAutomaton& N = A.freeze();
+    uint32_t n = N.size();
+    uint32_t k = N.alphabetSize();
+
+    SubsetStepper stepper(N);
+    ThreadPool pool(numThreads);
+
+    // ------------------------------------------------------------
+    // Step 1: Sharded interning table and per-worker buffers.
+    // ------------------------------------------------------------
+    const unsigned SHARD_BITS = 6;
+
+    struct Shard {
+        std::mutex lock;
+        SubsetTable table;
+        vector<uint32_t> globalId;  ///< Local id → DFA id
+        explicit Shard(uint32_t universe) : table(universe) {}
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    for (unsigned i = 0; i < (1u << SHARD_BITS); i++) {
+        shards.push_back(make_unique<Shard>(n));
+    }
+
+    struct Item { uint32_t id, shard, local; };
+    struct Edge { uint32_t from, col, to; };
+
+    struct Worker {
+        SubsetStepper::Scratch sc;
+        vector<Item> discovered;
+        vector<Edge> edges;
+        vector<uint32_t> finals;
+        vector<uint8_t> used;
+    };
+
+    vector<Worker> workers(pool.size());
+    for (Worker& w : workers) {
+        w.sc = stepper.makeScratch();
+        w.used.assign(k, 0);
+    }
+
+    atomic<uint32_t> numStates(0);
+
+    auto intern = [&](const StateSet& subset, vector<Item>& discovered) -> uint32_t {
+        uint64_t h = subset.hash();
+        uint32_t si = (uint32_t)(h >> (64 - SHARD_BITS));
+        Shard& shard = *shards[si];
 
-        // Step 2b: Compute transitions for every symbol in the alphabet.
-        for (char c : A.alphabet) {
-            set<int> nextSet;  // The new subset reached by reading symbol c
+        lock_guard<std::mutex> guard(shard.lock);
+        bool inserted;
+        uint32_t local = shard.table.intern(subset, h, inserted);
+        if (!inserted) return shard.globalId[local];
 
-            // For each NFA state in the current subset, gather reachable states on 'c'.
-            for (int state : current) {
-                auto it = A.transitions.find({state, c});
-                if (it != A.transitions.end()) {
-                    nextSet.insert(it->second.begin(), it->second.end());
+        uint32_t id = numStates++;
+        shard.globalId.push_back(id);
+        discovered.push_back({id, si, local});
+        return id;
+    };
+
+    // ------------------------------------------------------------
+    // Step 2: Level-synchronous BFS from the initial subset.
+    // ------------------------------------------------------------
+    vector<Item> frontier;
+    intern(stepper.start(), frontier);
+
+    while (!frontier.empty()) {
+        size_t grain = max<size_t>(1, min<size_t>(64, frontier.size() / (4 * pool.size())));
+
+        pool.parallelFor(frontier.size(), grain, [&](size_t begin, size_t end, unsigned w) {
+            Worker& W = workers[w];
+
+            for (size_t i = begin; i < end; i++) {
+                const Item& item = frontier[i];
+                {
+                    lock_guard<std::mutex> guard(shards[item.shard]->lock);
+                    shards[item.shard]->table.load(item.local, W.sc.current);
                 }
-            }
 
-            // If no transitions exist for this symbol, skip it.
-            if (nextSet.empty()) continue;
+                if (W.sc.current.intersects(stepper.finalMask)) W.finals.push_back(item.id);
 
-            // If this new subset of NFA states hasn’t been seen before,
-            // assign it a new DFA state ID and enqueue it for processing.
-            if (!stateMapping.count(nextSet)) {
-                stateMapping[nextSet] = nextStateId++;
-                q.push(nextSet);
+                stepper.step(W.sc, [&](uint32_t col, const StateSet& nextSet) {
+                    W.edges.push_back({item.id, col, intern(nextSet, W.discovered)});
+                    W.used[col] = 1;
+                });
             }
+        });
 
-            // Create the DFA transition: currentId --c--> stateMapping[nextSet]
-            D.transitions[{currentId, c}].insert(stateMapping[nextSet]);
+        frontier.clear();
+        for (Worker& W : workers) {
+            frontier.insert(frontier.end(), W.discovered.begin(), W.discovered.end());
+            W.discovered.clear();
+        }
+    }
 
-            // Ensure the symbol is included in the DFA’s alphabet.
-            D.alphabet.insert(c);
+    // ------------------------------------------------------------
+    // Step 3: Assemble the table.
+    // ------------------------------------------------------------
+    uint32_t total = numStates;
+    DenseDFA D(total, N.getSymbols());
+    vector<bool> used(k, false);
+
+    D.setInitial(0);
+    for (Worker& W : workers) {
+        for (const Edge& e : W.edges) D.setNext(e.from, e.col, e.to);
+        for (uint32_t s : W.finals) D.setFinal(s);
+        for (uint32_t col = 0; col < k; col++) {
+            if (W.used[col]) used[col] = true;
         }
+        W.edges = vector<Edge>();
     }
 
-    // Step 3: Add a dead (sink) state to make the DFA total (complete).
-    // -----------------------------------------------------------------
-    // This ensures every state has a transition for every symbol.
-    int deadState = nextStateId++;
-    bool usedDead = false;
+    if (!canonicalNumbering) return finishDFA(D, used, complete);
 
-    for (int s : D.states) {
-        for (char c : D.alphabet) {
-            // If a transition is missing, send it to the dead state.
-            if (!D.transitions.count({s, c})) {
-                D.transitions[{s, c}].insert(deadState);
-                usedDead = true;
+    // ------------------------------------------------------------
+    // Step 4: Renumber in sequential discovery order.
+    // ------------------------------------------------------------
+    vector<uint32_t> newId(total, DenseDFA::NONE);
+    vector<uint32_t> order;
+    order.reserve(total);
+
+    newId[0] = 0;
+    order.push_back(0);
+
+    for (size_t i = 0; i < order.size(); i++) {
+        for (uint32_t col = 0; col < k; col++) {
+            uint32_t t = D.next(order[i], col);
+            if (t != DenseDFA::NONE && newId[t] == DenseDFA::NONE) {
+                newId[t] = (uint32_t)order.size();
+                order.push_back(t);
             }
         }
     }
 
-    // If the dead state was used, add self-loops on all symbols.
-    if (usedDead) {
-        D.states.insert(deadState);
-        for (char c : D.alphabet) {
-            D.transitions[{deadState, c}].insert(deadState);
+    DenseDFA R(total, N.getSymbols());
+    R.setInitial(0);
+
+    for (uint32_t s = 0; s < total; s++) {
+        uint32_t r = newId[s];
+        if (D.isFinal(s)) R.setFinal(r);
+        for (uint32_t col = 0; col < k; col++) {
+            uint32_t t = D.next(s, col);
+            if (t != DenseDFA::NONE) R.setNext(r, col, newId[t]);
         }
     }
 
-    // Step 4: Return the constructed deterministic automaton.
-    return D;
+    return finishDFA(R, used, complete);
 }
@@ -0,0 +1,490 @@
+#include "../include/DFAMatcher.h"
+#include "../include/DenseDFA.h"
+#include "../include/StateSet.h"
+#include "../include/SubsetTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+/**
+ * @brief Compiles a DFA into the byte-class table.
+ *
+ * @details
+ * 1. Convert to a DenseDFA.
+ * 2. Find the live states (those that can reach a final state) with a
+ *    backward BFS; give each a row 1 .. L in index order, all others row 0.
+ * 3. Group the alphabet columns by their (row-mapped) contents: identical
+ *    columns share a byte class, and a column that always leads to row 0
+ *    joins class 0 with the bytes outside the alphabet.
+ * 4. Fill the table with premultiplied row ids.
+ *
+ * The reverse search of findFirst() is only allocated here; it builds
+ * nothing before the first search.
+ *
+ * @param A             Deterministic automaton (partial DFAs allowed).
+ * @param reverseBudget Per-thread cache size of the reverse search.
+ */
+DFAMatcher::DFAMatcher(const Automaton& A, size_t reverseBudget)
+    : reverse(make_unique<ReverseSearch>(reverseBudget)) {
+    DenseDFA D = DenseDFA::fromAutomaton(A);
+    uint32_t n = D.size();
+    uint32_t k = D.alphabetSize();
+
+    // ------------------------------------------------------------
+    // Step 1: Live states, by BFS over reversed transitions.
+    // ------------------------------------------------------------
+    vector<uint32_t> inOffset(n + 1, 0), inSource;
+    for (uint32_t q = 0; q < n; q++) {
+        for (uint32_t c = 0; c < k; c++) {
+            uint32_t t = D.next(q, c);
+            if (t != DenseDFA::NONE) inOffset[t + 1]++;
+        }
+    }
+    for (uint32_t q = 0; q < n; q++) inOffset[q + 1] += inOffset[q];
+
+    inSource.resize(inOffset[n]);
+    {
+        vector<uint32_t> cursor(inOffset.begin(), inOffset.end() - 1);
+        for (uint32_t q = 0; q < n; q++) {
+            for (uint32_t c = 0; c < k; c++) {
+                uint32_t t = D.next(q, c);
+                if (t != DenseDFA::NONE) inSource[cursor[t]++] = q;
+            }
+        }
+    }
+
+    vector<uint8_t> live(n, 0);
+    vector<uint32_t> queue;
+    for (uint32_t q = 0; q < n; q++) {
+        if (D.isFinal(q)) {
+            live[q] = 1;
+            queue.push_back(q);
+        }
+    }
+    for (size_t i = 0; i < queue.size(); i++) {
+        uint32_t t = queue[i];
+        for (uint32_t j = inOffset[t]; j < inOffset[t + 1]; j++) {
+            uint32_t q = inSource[j];
+            if (!live[q]) {
+                live[q] = 1;
+                queue.push_back(q);
+            }
+        }
+    }
+
+    vector<uint32_t> rowOf(n, 0);
+    vector<uint32_t> stateOfRow(1, DenseDFA::NONE);
+    for (uint32_t q = 0; q < n; q++) {
+        if (live[q]) {
+            rowOf[q] = (uint32_t)stateOfRow.size();
+            stateOfRow.push_back(q);
+        }
+    }
+    numRows = (uint32_t)stateOfRow.size();
+
+    // ------------------------------------------------------------
+    // Step 2: Byte classes from identical columns.
+    // ------------------------------------------------------------
+    vector<uint32_t> classOfColumn(k, 0);
+    map<vector<uint32_t>, uint32_t> classOfSignature;
+    classOfSignature[vector<uint32_t>(numRows, 0)] = 0;
+
+    for (uint32_t c = 0; c < k; c++) {
+        vector<uint32_t> signature(numRows, 0);
+        for (uint32_t r = 1; r < numRows; r++) {
+            uint32_t t = D.next(stateOfRow[r], c);
+            signature[r] = (t == DenseDFA::NONE) ? 0 : rowOf[t];
+        }
+
+        auto found = classOfSignature.emplace(signature, (uint32_t)classOfSignature.size()).first;
+        classOfColumn[c] = found->second;
+    }
+    classes = (uint32_t)classOfSignature.size();
+
+    for (unsigned b = 0; b < 256; b++) {
+        int c = D.column((char)b);
+        byteClass[b] = (uint16_t)(c < 0 ? 0 : classOfColumn[c]);
+    }
+
+    // ------------------------------------------------------------
+    // Step 3: Premultiplied table and final rows.
+    // ------------------------------------------------------------
+    table.assign((size_t)numRows * classes, 0);
+    finals.assign((size_t)numRows * classes, 0);
+
+    for (uint32_t r = 1; r < numRows; r++) {
+        uint32_t q = stateOfRow[r];
+        finals[(size_t)r * classes] = D.isFinal(q) ? 1 : 0;
+
+        for (uint32_t c = 0; c < k; c++) {
+            uint32_t t = D.next(q, c);
+            uint32_t target = (t == DenseDFA::NONE) ? 0 : rowOf[t];
+            table[(size_t)r * classes + classOfColumn[c]] = target * classes;
+        }
+    }
+
+    uint32_t q0 = D.getInitial();
+    start = (q0 == DenseDFA::NONE) ? 0 : rowOf[q0] * classes;
+
+    // A final row that maps every class (class 0 included) to itself.
+    for (uint32_t r = 1; r < numRows && acceptAll == NO_ROW; r++) {
+        if (!finals[(size_t)r * classes]) continue;
+
+        const uint32_t* rowPtr = table.data() + (size_t)r * classes;
+        if (all_of(rowPtr, rowPtr + classes, [&](uint32_t t) { return t == r * classes; })) {
+            acceptAll = r * classes;
+        }
+    }
+}
+
+/**
+ * @brief Inner scan loop, unrolled by four; the dead and accept-all rows
+ *        map to themselves, so checking for them once per block is enough.
+ */
+uint32_t DFAMatcher::run(uint32_t row, const unsigned char* p, const unsigned char* end) const {
+    const uint32_t* T = table.data();
+    const uint16_t* cls = byteClass;
+
+    while (end - p >= 4 && !isDecided(row)) {
+        row = T[row + cls[p[0]]];
+        row = T[row + cls[p[1]]];
+        row = T[row + cls[p[2]]];
+        row = T[row + cls[p[3]]];
+        p += 4;
+    }
+    while (p < end && !isDecided(row)) {
+        row = T[row + cls[*p++]];
+    }
+
+    return row;
+}
+
+bool DFAMatcher::accepts(string_view text) const {
+    auto p = (const unsigned char*)text.data();
+    return isFinalRow(run(start, p, p + text.size()));
+}
+
+/**
+ * @brief Lazy DFA for Σ*·reverse(L) over the rows and byte classes of a
+ *        matcher's table.
+ *
+ * @details
+ * A state is a set of live rows: those from which the text read so far,
+ * backwards, leads to a final row.  The final rows belong to every state
+ * (the Σ* prefix), and a state holding the start row marks a match
+ * start.  Stepping on class c replaces each row by its predecessors on
+ * c, taken from an index built once, on the first search.
+ *
+ * States are cached as in LazyDFA (a SubsetTable and a transition row
+ * per state), in a Cache of at most `budget` bytes.  Each search takes a
+ * Cache from a pool of idle ones (or makes one), so concurrent searches
+ * never share one and warm caches are reused by later searches.
+ */
+class DFAMatcher::ReverseSearch {
+public:
+    explicit ReverseSearch(size_t budget) : budget(budget) {}
+
+    /**
+     * @brief Leftmost match start in data[0, len), SIZE_MAX if none.
+     *
+     * @return False, with begin unset, if the cache filled up first.
+     */
+    bool leftmostStart(const DFAMatcher& M, const unsigned char* data, size_t len, size_t& begin);
+
+private:
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    struct Cache {
+        SubsetTable table;
+        vector<uint32_t> next;      ///< state × classes → state, or UNKNOWN
+        vector<uint8_t> starts;     ///< starts[s] ⇔ s holds the start row
+        StateSet current;
+        StateSet successor;
+
+        explicit Cache(uint32_t rows) : table(rows), current(rows), successor(rows) {}
+    };
+
+    size_t budget;
+
+    once_flag indexed;
+    vector<uint32_t> predOffset;    ///< (row × classes + class) → range of predSource
+    vector<uint32_t> predSource;
+    StateSet finalRows;
+
+    mutex poolLock;
+    vector<unique_ptr<Cache>> idle;
+
+    void buildIndex(const DFAMatcher& M);
+    bool scan(const DFAMatcher& M, Cache& C, const unsigned char* data, size_t len, size_t& begin);
+    uint32_t intern(const DFAMatcher& M, Cache& C, const StateSet& S);
+
+    /// Bytes of one cached state: subset words, fingerprint, two hash
+    /// slots, transition row and start flag.
+    size_t memoryUsage(const DFAMatcher& M, const Cache& C) const {
+        size_t perState = C.current.numWords() * sizeof(uint64_t) + sizeof(uint64_t) +
+                          2 * sizeof(uint32_t) + M.classes * sizeof(uint32_t) + 1;
+        return (size_t)C.table.size() * perState;
+    }
+};
+
+/**
+ * @brief Predecessor lists of every (row, class), in CSR form, and the
+ *        set of final rows.
+ */
+void DFAMatcher::ReverseSearch::buildIndex(const DFAMatcher& M) {
+    uint32_t rows = M.numRows, k = M.classes;
+
+    predOffset.assign((size_t)rows * k + 1, 0);
+    for (uint32_t r = 1; r < rows; r++) {
+        for (uint32_t c = 0; c < k; c++) {
+            uint32_t t = M.table[(size_t)r * k + c] / k;
+            if (t != 0) predOffset[(size_t)t * k + c + 1]++;
+        }
+    }
+    for (size_t i = 0; i + 1 < predOffset.size(); i++) predOffset[i + 1] += predOffset[i];
+
+    predSource.resize(predOffset.back());
+    vector<uint32_t> cursor(predOffset.begin(), predOffset.end() - 1);
+    for (uint32_t r = 1; r < rows; r++) {
+        for (uint32_t c = 0; c < k; c++) {
+            uint32_t t = M.table[(size_t)r * k + c] / k;
+            if (t != 0) predSource[cursor[(size_t)t * k + c]++] = r;
+        }
+    }
+
+    finalRows = StateSet(rows);
+    for (uint32_t r = 1; r < rows; r++) {
+        if (M.finals[(size_t)r * k]) finalRows.insert(r);
+    }
+}
+
+uint32_t DFAMatcher::ReverseSearch::intern(const DFAMatcher& M, Cache& C, const StateSet& S) {
+    bool inserted;
+    uint32_t id = C.table.intern(S, inserted);
+
+    if (inserted) {
+        C.next.resize(C.next.size() + M.classes, UNKNOWN);
+        C.starts.push_back(S.contains(M.start / M.classes) ? 1 : 0);
+    }
+    return id;
+}
+
+bool DFAMatcher::ReverseSearch::leftmostStart(const DFAMatcher& M, const unsigned char* data,
+                                              size_t len, size_t& begin) {
+    call_once(indexed, [&] { buildIndex(M); });
+
+    unique_ptr<Cache> C;
+    {
+        lock_guard<mutex> guard(poolLock);
+        if (!idle.empty()) {
+            C = std::move(idle.back());
+            idle.pop_back();
+        }
+    }
+    if (!C) C = make_unique<Cache>(M.numRows);
+
+    bool complete = scan(M, *C, data, len, begin);
+    if (!complete) {
+        // Start over next time rather than keep a cache that is full.
+        C->table.clear();
+        C->next.clear();
+        C->starts.clear();
+    }
+
+    lock_guard<mutex> guard(poolLock);
+    idle.push_back(std::move(C));
+    return complete;
+}
+
+/**
+ * @brief Backward pass: every position where the state holds the start
+ *        row starts a match, and the last one seen is the leftmost.
+ */
+bool DFAMatcher::ReverseSearch::scan(const DFAMatcher& M, Cache& C, const unsigned char* data,
+                                     size_t len, size_t& begin) {
+    uint32_t k = M.classes;
+    uint32_t state = intern(M, C, finalRows);
+    size_t found = SIZE_MAX;
+
+    for (size_t i = len; i-- > 0;) {
+        uint32_t c = M.byteClass[data[i]];
+        uint32_t t = C.next[(size_t)state * k + c];
+
+        if (t == UNKNOWN) {
+            if (memoryUsage(M, C) > budget) return false;
+
+            C.table.load(state, C.current);
+            C.successor.clear();
+            C.successor.unionWith(finalRows);
+            C.current.forEach([&](uint32_t row) {
+                size_t slot = (size_t)row * k + c;
+                for (uint32_t j = predOffset[slot]; j < predOffset[slot + 1]; j++) {
+                    C.successor.insert(predSource[j]);
+                }
+            });
+
+            t = intern(M, C, C.successor);
+            C.next[(size_t)state * k + c] = t;
+        }
+
+        state = t;
+        if (C.starts[state]) found = i;
+    }
+
+    begin = found;
+    return true;
+}
+
+DFAMatcher::~DFAMatcher() = default;
+DFAMatcher::DFAMatcher(DFAMatcher&&) noexcept = default;
+DFAMatcher& DFAMatcher::operator=(DFAMatcher&&) noexcept = default;
+
+size_t DFAMatcher::longestEnd(const unsigned char* data, size_t len, size_t begin) const {
+    const uint32_t* T = table.data();
+    uint32_t row = start;
+    size_t lastEnd = isFinalRow(row) ? begin : SIZE_MAX;
+
+    for (size_t j = begin; j < len; j++) {
+        row = T[row + byteClass[data[j]]];
+        if (row == 0) break;
+        if (isFinalRow(row)) lastEnd = j + 1;
+    }
+    return lastEnd;
+}
+
+/**
+ * @brief Leftmost-longest search.
+ *
+ * @details
+ * 1. The leftmost match start comes from the reverse search, one
+ *    backward pass over the text (position 0 if the empty word matches).
+ * 2. From that start the forward DFA runs until the dead row (or the end
+ *    of the text); the last position where it was in a final row is the
+ *    longest end.
+ *
+ * If the reverse search runs out of cache, start positions are instead
+ * tried left to right, each with the scan of step 2, until one matches.
+ */
+bool DFAMatcher::findFirst(string_view text, Match& match) const {
+    if (start == 0) return false;
+
+    auto data = (const unsigned char*)text.data();
+    size_t len = text.size();
+
+    // ------ Step 1: Leftmost start
+    size_t begin = 0;
+
+    if (!isFinalRow(start) && !reverse->leftmostStart(*this, data, len, begin)) {
+        for (size_t i = 0; i <= len; i++) {
+            size_t end = longestEnd(data, len, i);
+            if (end != SIZE_MAX) {
+                match.begin = i;
+                match.end = end;
+                return true;
+            }
+        }
+        return false;
+    }
+    if (begin == SIZE_MAX) return false;
+
+    // ------ Step 2: Longest end from there
+    match.begin = begin;
+    match.end = longestEnd(data, len, begin);
+    return true;
+}
+
+/**
+ * @brief Whole-line matching over a buffer.
+ *
+ * @details
+ * The buffer is cut just after '\n' bytes into LANES segments of about
+ * equal size.  Every segment starts at a line start, so the lanes are
+ * independent and are scanned together, one byte of each per iteration:
+ * their table loads overlap instead of forming one dependency chain.
+ *
+ * On '\n' a lane counts its line if it ended in a final row and restarts
+ * from the start row; the test is a well-predicted branch since lines are
+ * long compared with one byte.  Whatever remains of the longer segments
+ * after the shortest one ends is scanned one line at a time.
+ */
+size_t DFAMatcher::countMatchingLines(string_view buffer) const {
+    constexpr int LANES = 4;
+
+    auto begin = (const unsigned char*)buffer.data();
+    auto end = begin + buffer.size();
+
+    // ------------------------------------------------------------
+    // Step 1: Segment boundaries, each just after a '\n'.
+    // ------------------------------------------------------------
+    const unsigned char* bound[LANES + 1];
+    bound[0] = begin;
+    for (int i = 1; i < LANES; i++) {
+        const unsigned char* target = begin + buffer.size() * i / LANES;
+        if (target < bound[i - 1]) target = bound[i - 1];
+
+        auto nl = (const unsigned char*)memchr(target, '\n', end - target);
+        bound[i] = nl ? nl + 1 : end;
+    }
+    bound[LANES] = end;
+
+    size_t shortest = SIZE_MAX;
+    for (int i = 0; i < LANES; i++) {
+        shortest = min(shortest, (size_t)(bound[i + 1] - bound[i]));
+    }
+
+    // ------------------------------------------------------------
+    // Step 2: Interleaved scan of the first `shortest` bytes.
+    // ------------------------------------------------------------
+    const uint32_t* T = table.data();
+    const uint16_t* cls = byteClass;
+    const uint8_t* F = finals.data();
+
+    const unsigned char *p0 = bound[0], *p1 = bound[1], *p2 = bound[2], *p3 = bound[3];
+    uint32_t r0 = start, r1 = start, r2 = start, r3 = start;
+    size_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+
+    for (size_t i = 0; i < shortest; i++) {
+        unsigned char a0 = p0[i], a1 = p1[i], a2 = p2[i], a3 = p3[i];
+
+        if (a0 == '\n') { c0 += F[r0]; r0 = start; } else r0 = T[r0 + cls[a0]];
+        if (a1 == '\n') { c1 += F[r1]; r1 = start; } else r1 = T[r1 + cls[a1]];
+        if (a2 == '\n') { c2 += F[r2]; r2 = start; } else r2 = T[r2 + cls[a2]];
+        if (a3 == '\n') { c3 += F[r3]; r3 = start; } else r3 = T[r3 + cls[a3]];
+    }
+
+    size_t count = c0 + c1 + c2 + c3;
+
+    // ------------------------------------------------------------
+    // Step 3: Rest of each segment, line by line.  The first line
+    // continues from the lane's row.
+    // ------------------------------------------------------------
+    uint32_t rows[LANES] = { r0, r1, r2, r3 };
+
+    for (int i = 0; i < LANES; i++) {
+        const unsigned char* p = bound[i] + shortest;
+        const unsigned char* segEnd = bound[i + 1];
+        uint32_t row = rows[i];
+
+        // A lane that has just passed a '\n' (or never started) has no
+        // pending line.
+        bool inLine = shortest > 0 && p[-1] != '\n';
+
+        while (p < segEnd || inLine) {
+            auto nl = (const unsigned char*)memchr(p, '\n', segEnd - p);
+            auto lineEnd = nl ? nl : segEnd;
+
+            if (!inLine) row = start;
+            row = run(row, p, lineEnd);
+            if (F[row]) count++;
+
+            inLine = false;
+            p = nl ? nl + 1 : segEnd;
+        }
+    }
+
+    return count;
+}
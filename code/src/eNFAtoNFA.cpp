@@ -1,75 +1,17 @@
 #include "../include/Automaton.h"
+#include "../include/CSRAutomaton.h"
 #include "../include/Dot.h"
+#include "../include/EpsilonClosure.h"
 #include "../include/RegexENFA.h"
+#include "../include/StateSet.h"
+#include "../include/SubsetTable.h"
 
+#include <algorithm>
 #include <iostream>
-#include <map>
-#include <queue>
-#include <set>
 #include <string>
 
 using namespace std;
 
-/**
- * @brief Computes the ε-closure (epsilon-closure) of a single state in an automaton.
- *
- * @details
- * The ε-closure of a state `q` in an ε-NFA `A = (Q, Σ ∪ {ε}, δ, I, F)` is defined as:
- *   ε-closure(q) = { q' ∈ Q | q →* q' via ε-transitions only }
- *
- * That is, all states reachable from `q` by taking zero or more ε-transitions (`#` here represents ε).
- *
- * @param A       The ε-NFA automaton.
- * @param state   The starting state whose ε-closure is to be computed.
- * @return        A set of states reachable from `state` by only ε-transitions.
- */
-static set<int> epsilonClosure(const Automaton& A, int state) {
-    set<int> closure;
-    queue<int> q;
-
-    // Initialize closure with the starting state itself
-    closure.insert(state);
-    q.push(state);
-
-    // Standard BFS over ε-transitions
-    while (!q.empty()) {
-        int s = q.front(); 
-        q.pop();
-
-        // Look for ε-transitions from this state ('#' denotes ε)
-        auto it = A.getTransitions().find({s, '#'});
-        if (it != A.getTransitions().end()) {
-            for (int t : it->second) {
-                // If we haven’t already added this state, add it and continue exploring
-                if (!closure.count(t)) {
-                    closure.insert(t);
-                    q.push(t);
-                }
-            }
-        }
-    }
-
-    return closure;
-}
-
-/**
- * @brief Computes the ε-closure of a *set* of states.
- *
- * This is simply the union of the ε-closures of all states in the given set.
- *
- * @param A       The ε-NFA automaton.
- * @param states  A set of states.
- * @return        A set containing all states reachable by ε-transitions from any state in `states`.
- */
-static set<int> epsilonClosureSet(const Automaton& A, const set<int>& states) {
-    set<int> closure;
-    for (int s : states) {
-        set<int> temp = epsilonClosure(A, s);
-        closure.insert(temp.begin(), temp.end());
-    }
-    return closure;
-}
-
 /**
  * @brief Converts an ε-NFA (E) into an equivalent NFA (N) without ε-transitions.
  *
@@ -91,90 +33,113 @@ static set<int> epsilonClosureSet(const Automaton& A, const set<int>& states) {
  * - The algorithm performs a BFS over subsets of ε-closures.
  * - Each unique set of ε-reachable states is represented as a distinct NFA state.
  * - The transition symbol '#' is treated as ε.
+ * - ε-closures of all states are computed once up front (EpsilonClosure:
+ *   SCC condensation of the ε-graph), so closing a target is a bitset OR.
+ * - Purely in memory: nothing is read or written.
  *
- * @param inputBaseName  Base name of the input ε-NFA file (without extension).
- *                       Reads from "../../outputs/enfa_<inputBaseName>.txt".
- * @return               An Automaton object representing the equivalent NFA.
+ * @param E  The ε-NFA.
+ * @return   An Automaton object representing the equivalent NFA.
  */
-Automaton eNFAtoNFA(const string& inputBaseName) {
-    // Step 1: Construct file paths for input and outputs.
-    string inputPath  = "../../outputs/enfa_" + inputBaseName + ".txt";
-    string outputPath = "../../outputs/nfa_"  + inputBaseName + ".txt";
-    string dotPath    = "../../dots/nfa_"     + inputBaseName + ".dot";
+Automaton eNFAtoNFA(const Automaton& E) {
+    const CSRAutomaton& C = E.freeze();
+    const string& symbols = C.getSymbols();
 
-    // Step 2: Read the ε-NFA from file.
-    Automaton E = Automaton::readAutomaton(inputPath);
-
-    // Step 3: Create a new Automaton N (the resulting NFA).
+    // Step 1: Create a new Automaton N (the resulting NFA).
     Automaton N;
     N.setAlphabet(E.getAlphabet());  // Copy alphabet (excluding ε later)
 
-    // Step 4: Maps subsets of ε-NFA states → unique NFA state IDs.
-    map<set<int>, int> stateMapping;
-    queue<set<int>> q;
-    int nextId = 0;
+    uint32_t n = C.size();
+    uint32_t k = C.alphabetSize();
+
+    StateSet finalMask(n);
+    for (uint32_t s = 0; s < n; s++) {
+        if (C.isFinal(s)) finalMask.insert(s);
+    }
 
-    // Step 5: Compute ε-closure of the ε-NFA’s initial states → new start state.
-    set<int> startClosure = epsilonClosureSet(E, E.getInitialStates());
-    q.push(startClosure);
-    stateMapping[startClosure] = nextId++;
+    // Step 2: Maps subsets of ε-NFA states → unique NFA state IDs.
+    // IDs are handed out in discovery order, so walking them in order is
+    // the BFS queue.
+    SubsetTable stateMapping(n);
+    EpsilonClosure closure(C);
+
+    auto intern = [&](const StateSet& subset) -> int {
+        bool inserted;
+        return (int)stateMapping.intern(subset, inserted);
+    };
+
+    // Step 3: Compute ε-closure of the ε-NFA’s initial states → new start state.
+    StateSet startClosure(n);
+    for (uint32_t s : C.getInitialStates()) closure.addTo(s, startClosure);
+    intern(startClosure);
     N.addInitialState(0);
 
-    // Step 6: BFS over all reachable subsets of states.
-    while (!q.empty()) {
-        set<int> current = q.front(); 
-        q.pop();
+    // One successor accumulator per column, and the columns touched so far.
+    vector<StateSet> nextStates(k, StateSet(n));
+    vector<uint8_t> isTouched(k, 0);
+    vector<uint32_t> touched;
+
+    // Step 4: BFS over all reachable subsets of states.
+    StateSet current(n);
 
-        int curId = stateMapping[current];
+    for (uint32_t i = 0; i < stateMapping.size(); i++) {
+        stateMapping.load(i, current);
+        int curId = (int)i;
         N.addState(curId);
 
         // Mark as final if any original ε-NFA final state is contained in this set.
-        for (int s : current) {
-            if (E.getFinalStates().count(s)) {
-                N.addFinalState(curId);
-                break;
-            }
-        }
-
-        // Step 7: Process transitions for all non-ε symbols.
-        for (char c : E.getAlphabet()) {
-            if (c == '#') continue;  // Skip ε
-
-            set<int> nextStates;
-
-            // For each state in the current set, collect transitions on symbol c.
-            for (int s : current) {
-                auto it = E.getTransitions().find({s, c});
-                if (it != E.getTransitions().end()) {
-                    for (int t : it->second) {
-                        // Apply ε-closure to each target state
-                        set<int> tClosure = epsilonClosure(E, t);
-                        nextStates.insert(tClosure.begin(), tClosure.end());
-                    }
+        if (current.intersects(finalMask)) N.addFinalState(curId);
+
+        // Step 5: Follow the non-ε edges leaving the set (ε lives in its
+        // own CSR arrays), applying ε-closure to each target reached.
+        touched.clear();
+        current.forEach([&](uint32_t s) {
+            for (uint32_t e = C.edgeBegin(s); e < C.edgeEnd(s); e++) {
+                uint32_t col = C.edgeColumn(e);
+                if (!isTouched[col]) {
+                    isTouched[col] = 1;
+                    touched.push_back(col);
+                }
+                for (const uint32_t* t = C.targetsBegin(e); t != C.targetsEnd(e); ++t) {
+                    closure.addTo(*t, nextStates[col]);
                 }
             }
+        });
+        sort(touched.begin(), touched.end());
 
-            if (nextStates.empty()) continue;
-
+        for (uint32_t col : touched) {
             // If we discover a new subset, assign it a new state ID.
-            if (!stateMapping.count(nextStates)) {
-                stateMapping[nextStates] = nextId++;
-                q.push(nextStates);
-            }
-
             // Add the resulting transition to the new NFA.
-            N.addTransition(curId, c, stateMapping[nextStates]);
+            N.addTransition(curId, symbols[col], intern(nextStates[col]));
+
+            nextStates[col].clear();
+            isTouched[col] = 0;
         }
     }
 
-    // Step 8: Write the resulting NFA to file.
-    N.writeAutomaton(outputPath);
+    return N;
+}
+
+/**
+ * @brief File-based wrapper of eNFAtoNFA(const Automaton&).
+ *
+ * @param inputBaseName  Base name of the input ε-NFA file (without extension).
+ *                       Reads from "../../outputs/enfa_<inputBaseName>.txt".
+ * @return               An Automaton object representing the equivalent NFA.
+ */
+Automaton eNFAtoNFA(const string& inputBaseName) {
+    // Step 1: Construct file paths for input and outputs.
+    string inputPath  = "../../outputs/enfa_" + inputBaseName + ".txt";
+    string outputPath = "../../outputs/nfa_"  + inputBaseName + ".txt";
+    string dotPath    = "../../dots/nfa_"     + inputBaseName + ".dot";
+
+    // Step 2: Read the ε-NFA from file and remove its ε-transitions.
+    Automaton N = eNFAtoNFA(Automaton::readAutomaton(inputPath));
 
-    // Step 9: Generate visualization for the new NFA.
+    // Step 3: Write the resulting NFA to file, with its visualization
+    //         (as far as the artifact policy allows).
     Dot dotGen;
-    dotGen.generateDot(outputPath, dotPath, "NFA");
-    dotGen.generateImage(dotPath, "nfa_", inputBaseName);
+    dotGen.writeArtifacts(N, outputPath, dotPath, "NFA", "nfa_", inputBaseName);
 
-    // Step 10: Return the constructed NFA.
+    // Step 4: Return the constructed NFA.
     return N;
 }
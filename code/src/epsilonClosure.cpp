@@ -0,0 +1,162 @@
+#include "../include/EpsilonClosure.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+/**
+ * @brief Condenses the ε-graph and builds the closure table.
+ *
+ * @details
+ * 1. Tarjan's algorithm with an explicit call stack, so long ε-chains
+ *    (Thompson automata of big regexes) cannot overflow the C++ stack.
+ *    Components are numbered in finishing order: every ε-edge leaves a
+ *    component for one with a smaller number, or stays inside.
+ * 2. A component is trivial if it is one state without ε-edges to other
+ *    states; its closure is that state alone.
+ * 3. In increasing component order, each non-trivial closure is its
+ *    members plus the closures of its ε-successors, already complete.
+ */
+EpsilonClosure::EpsilonClosure(const CSRAutomaton& A, size_t memoryBudget)
+    : wordsPerSet((A.size() + 63) / 64) {
+
+    uint32_t n = A.size();
+    component.assign(n, NONE);
+
+    // ------------------------------------------------------------
+    // Step 1: Strongly connected components of the ε-edges.
+    // ------------------------------------------------------------
+    vector<uint32_t> index(n, NONE), low(n, 0);
+    vector<uint8_t> onStack(n, 0);
+    vector<uint32_t> sccStack;
+    vector<pair<uint32_t, const uint32_t*>> calls;
+    uint32_t counter = 0;
+    uint32_t numComps = 0;
+
+    auto visit = [&](uint32_t v) {
+        index[v] = low[v] = counter++;
+        sccStack.push_back(v);
+        onStack[v] = 1;
+        calls.push_back({ v, A.epsilonBegin(v) });
+    };
+
+    for (uint32_t s = 0; s < n; s++) {
+        if (index[s] != NONE) continue;
+        visit(s);
+
+        while (!calls.empty()) {
+            uint32_t v = calls.back().first;
+            const uint32_t*& it = calls.back().second;
+
+            if (it != A.epsilonEnd(v)) {
+                uint32_t w = *it++;
+                if (index[w] == NONE) {
+                    visit(w);
+                } else if (onStack[w]) {
+                    low[v] = min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            calls.pop_back();
+            if (!calls.empty()) {
+                uint32_t u = calls.back().first;
+                low[u] = min(low[u], low[v]);
+            }
+
+            if (low[v] == index[v]) {
+                uint32_t w;
+                do {
+                    w = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[w] = 0;
+                    component[w] = numComps;
+                } while (w != v);
+                numComps++;
+            }
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Step 2: Members of each component; which ones are trivial.
+    // ------------------------------------------------------------
+    vector<uint32_t> memberOffset(numComps + 1, 0), members(n);
+    for (uint32_t q = 0; q < n; q++) memberOffset[component[q] + 1]++;
+    for (uint32_t c = 0; c < numComps; c++) memberOffset[c + 1] += memberOffset[c];
+    {
+        vector<uint32_t> cursor(memberOffset.begin(), memberOffset.end() - 1);
+        for (uint32_t q = 0; q < n; q++) members[cursor[component[q]]++] = q;
+    }
+
+    rowOf.assign(numComps, NONE);
+    uint32_t numRows = 0;
+
+    for (uint32_t c = 0; c < numComps; c++) {
+        bool trivial = memberOffset[c + 1] - memberOffset[c] == 1;
+        if (trivial) {
+            uint32_t q = members[memberOffset[c]];
+            for (const uint32_t* t = A.epsilonBegin(q); t != A.epsilonEnd(q); ++t) {
+                if (*t != q) trivial = false;
+            }
+        }
+        if (!trivial) rowOf[c] = numRows++;
+    }
+
+    if ((size_t)numRows * wordsPerSet * sizeof(uint64_t) > memoryBudget) {
+        precomputed = false;
+        epsilonOffset.assign(1, 0);
+        for (uint32_t q = 0; q < n; q++) {
+            epsilonTargets.insert(epsilonTargets.end(), A.epsilonBegin(q), A.epsilonEnd(q));
+            epsilonOffset.push_back((uint32_t)epsilonTargets.size());
+        }
+        return;
+    }
+
+    // ------------------------------------------------------------
+    // Step 3: Closure rows, successors first.
+    // ------------------------------------------------------------
+    rows.assign((size_t)numRows * wordsPerSet, 0);
+
+    for (uint32_t c = 0; c < numComps; c++) {
+        if (rowOf[c] == NONE) continue;
+        uint64_t* row = rows.data() + (size_t)rowOf[c] * wordsPerSet;
+
+        for (uint32_t i = memberOffset[c]; i < memberOffset[c + 1]; i++) {
+            uint32_t q = members[i];
+            row[q >> 6] |= uint64_t(1) << (q & 63);
+
+            for (const uint32_t* t = A.epsilonBegin(q); t != A.epsilonEnd(q); ++t) {
+                uint32_t d = component[*t];
+                if (d == c) continue;
+
+                if (rowOf[d] == NONE) {
+                    row[*t >> 6] |= uint64_t(1) << (*t & 63);
+                } else {
+                    const uint64_t* src = rows.data() + (size_t)rowOf[d] * wordsPerSet;
+                    for (uint32_t w = 0; w < wordsPerSet; w++) row[w] |= src[w];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Adds ε-closure(q) to S by depth-first search, using S as the
+ *        visited set (see addTo() for why that is enough).
+ */
+void EpsilonClosure::search(uint32_t q, StateSet& S) const {
+    vector<uint32_t> stack;
+    S.insert(q);
+    stack.push_back(q);
+
+    while (!stack.empty()) {
+        uint32_t s = stack.back();
+        stack.pop_back();
+
+        for (uint32_t i = epsilonOffset[s]; i < epsilonOffset[s + 1]; i++) {
+            uint32_t t = epsilonTargets[i];
+            if (S.add(t)) stack.push_back(t);
+        }
+    }
+}
@@ -1,11 +1,8 @@
 #include "../include/Dot.h"
+#include "../include/RenderQueue.h"
 
 #include <fstream>
-#include <iostream>
-#include <sstream>
 #include <string>
-#include <tuple>
-#include <vector>
 
 using namespace std;
 
@@ -14,88 +11,46 @@ using namespace std;
  *        of an automaton described in a text file.
  *
  * @details
- * This function reads an automaton definition from a text file containing
- * the following sections:
+ * The file is parsed by Automaton::readAutomaton() (so every line of the
+ * INITIAL_STATES and FINAL_STATES sections counts) and drawn by
+ * generateDot(const Automaton&, ...).
  *
- *   TRANSITIONS:
- *      <from> <symbol> <to>
- *      ...
- *
- *   INITIAL_STATES:
- *      s1 s2 ...
- *
- *   FINAL_STATES:
- *      f1 f2 ...
+ * @param inputFile   Path to the automaton text file.
+ * @param outputFile  Path where the DOT file should be written.
+ * @param graphName   Name assigned to the DOT graph.
+ */
+void Dot::generateDot(const string& inputFile, const string& outputFile, const string& graphName) {
+    generateDot(Automaton::readAutomaton(inputFile), outputFile, graphName);
+}
+
+/**
+ * @brief Generates a Graphviz DOT file representing the structure
+ *        of an automaton in memory.
  *
- * Using this information, it produces a DOT file that Graphviz can render
- * into an image. The generated graph uses:
+ * @details
+ * The graph uses:
  *   - Left-to-right layout (rankdir=LR)
  *   - Double circles for final states
  *   - A small "start" point node with edges to initial states
  *   - Labeled edges for transitions
  *
+ * Transitions are listed in (from, symbol, to) order, as in the text
+ * format.
+ *
  * The DOT file can then be rendered into PNG/SVG using Dot::generateImage().
+ * It is written to a staging file and renamed into place, so a render of
+ * the previous version still in progress is not disturbed.
  *
- * @param inputFile   Path to the automaton text file.
+ * @param A           Automaton to draw.
  * @param outputFile  Path where the DOT file should be written.
  * @param graphName   Name assigned to the DOT graph.
  */
-void Dot::generateDot(const string& inputFile, const string& outputFile, const string& graphName) {
-    string line;
-
-    ifstream fin(inputFile);
-
-    // Containers for parsed automaton data
-    vector<tuple<int, char, int>> transitions;   // (from, symbol, to)
-    vector<int> initialStates;
-    vector<int> finalStates;
-
+void Dot::generateDot(const Automaton& A, const string& outputFile, const string& graphName) {
     // ---------------------------------------------------------------
-    // Step 1: Read and parse the automaton file.
+    // Write the DOT file describing the automaton graph.
     // ---------------------------------------------------------------
-    while (getline(fin, line)) {
-        // --- TRANSITIONS section ---
-        if (line == "TRANSITIONS:") {
-            // Read transitions until a blank line or next section
-            while (getline(fin, line) && !line.empty()) {
-                stringstream ss(line);
-
-                int from;
-                char c;
-                int to;
-
-                ss >> from >> c >> to;
-                transitions.push_back({from, c, to});
-            }
-        }
-        // --- INITIAL STATES section ---
-        else if (line == "INITIAL_STATES:") {
-            if (getline(fin, line)) {
-                stringstream ss(line);
-                int temp;
-
-                while (ss >> temp) {
-                    initialStates.push_back(temp);
-                }
-            }
-        }
-        // --- FINAL STATES section ---
-        else if (line == "FINAL_STATES:") {
-            if (getline(fin, line)) {
-                stringstream ss(line);
-                int temp;
-
-                while (ss >> temp) {
-                    finalStates.push_back(temp);
-                }
-            }
-        }
-    }
-
-    // ---------------------------------------------------------------
-    // Step 2: Write the DOT file describing the automaton graph.
-    // ---------------------------------------------------------------
-    ofstream fout(outputFile);
+    string stagingFile = RenderQueue::stagingPath(outputFile);
+    ofstream fout(stagingFile);
 
     // Begin DOT graph
     fout << "digraph " << graphName << " {"
@@ -105,7 +60,7 @@ void Dot::generateDot(const string& inputFile, const string& outputFile, const s
 
     // --- Final states drawn as double circles ---
     fout << "\t" << "node [shape = doublecircle];\n\t";
-    for (int finalState : finalStates) {
+    for (int finalState : A.getFinalStates()) {
         fout << finalState << " ";
     }
     fout << ";\n";
@@ -115,21 +70,26 @@ void Dot::generateDot(const string& inputFile, const string& outputFile, const s
 
     // --- Start point (invisible node) pointing to initial states ---
     fout << "\t" << "start [shape=point];\n\t";
-    for (int initialState : initialStates) {
+    for (int initialState : A.getInitialStates()) {
         fout << "start -> " << initialState << ";\n\t";
     }
 
     // --- Draw transitions ---
     fout << "\n\t";
-    for (auto& transition : transitions) {
-        fout << get<0>(transition)
-             << " -> "
-             << get<2>(transition)
-             << " [label=\""
-             << get<1>(transition)
-             << "\"];\n\t";
+    for (auto& [key, targets] : A.getTransitions()) {
+        for (int to : targets) {
+            fout << key.first
+                 << " -> "
+                 << to
+                 << " [label=\""
+                 << key.second
+                 << "\"];\n\t";
+        }
     }
 
     // End DOT graph
     fout << "\n}";
+    fout.close();
+
+    RenderQueue::commitFile(stagingFile, outputFile);
 }
@@ -1,14 +1,15 @@
 #include "../include/Dot.h"
+#include "../include/RenderQueue.h"
 
 #include <string>
 
 /**
- * @brief Generates a PNG image from a Graphviz DOT file.
+ * @brief Queues the rendering of a Graphviz DOT file into a PNG image.
  *
  * @details
- * This function constructs a shell command that:
+ * The job goes to RenderQueue::shared(), which:
  *   1. Ensures the `../../images/` directory exists.
- *   2. Invokes the `dot` command-line tool from Graphviz:
+ *   2. Runs the `dot` command-line tool from Graphviz:
  *
  *        dot -Tpng <dot-file> -o <output-image-path>
  *
@@ -25,20 +26,11 @@
  * @param filename  Base name for the output image file.
  *
  * @note
- * - Uses `system()` to execute the shell command.  
- *   Ensure the environment supports Graphviz (`dot` command installed).
- * - Automatically creates the images directory if it does not exist.
+ * - Returns at once: the image is rendered in the background, concurrently
+ *   with other renders.  Call RenderQueue::shared().waitAll() before
+ *   using it.
+ * - Ensure the environment supports Graphviz (`dot` command installed).
  */
 void Dot::generateImage(const std::string& file, const std::string& prefix, const std::string& filename) {
-
-    // Build shell command:
-    //   - mkdir -p ../../images/  → create directory if not exists
-    //   - dot -Tpng <file> -o <output-path>.png  → render DOT to PNG
-    std::string command =
-        "mkdir -p ../../images && "
-        "dot -Tpng " + file +
-        " -o ../../images/" + prefix + filename + ".png";
-
-    // Execute the command in the system shell
-    system(command.c_str());
+    RenderQueue::shared().submit(file, "../../images/" + prefix + filename + ".png");
 }
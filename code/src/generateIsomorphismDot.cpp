@@ -1,5 +1,6 @@
 #include "../include/Automaton.h"
 #include "../include/Dot.h"
+#include "../include/RenderQueue.h"
 
 #include <fstream>
 #include <map>
@@ -44,7 +45,10 @@ void Dot::generateIsomorphismDot(
     string dotFile = "../../dots/iso_" + filenameBase + ".dot";
     string pngFile = "../../images/iso_" + filenameBase + ".png";
 
-    ofstream fout(dotFile);
+    // Written aside and renamed into place: an earlier render may still
+    // be reading dotFile.
+    string stagingFile = RenderQueue::stagingPath(dotFile);
+    ofstream fout(stagingFile);
     if (!fout.is_open()) {
         cerr << "Error: Unable to open " << dotFile << " for writing.\n";
         return;
@@ -132,7 +136,11 @@ void Dot::generateIsomorphismDot(
     fout << "\n}\n";
     fout.close();
 
-    // Generate PNG image from DOT file using Graphviz
-    string command = "dot -Tpng \"" + dotFile + "\" -o \"" + pngFile + "\"";
-    system(command.c_str());
+    if (!RenderQueue::commitFile(stagingFile, dotFile)) {
+        cerr << "Error: Unable to write " << dotFile << ".\n";
+        return;
+    }
+
+    // Generate PNG image from DOT file using Graphviz (in the background)
+    RenderQueue::shared().submit(dotFile, pngFile);
 }
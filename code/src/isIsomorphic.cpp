@@ -1,8 +1,9 @@
 #include "../include/Automaton.h"
+#include "../include/DenseDFA.h"
 
 #include <map>
 #include <queue>
-#include <set>
+#include <vector>
 
 using namespace std;
 
@@ -17,6 +18,10 @@ using namespace std;
  *  2. q ∈ Final_A ⇔ f(q) ∈ Final_B
  *  3. For every transition δ_A(q, a) = q', we have δ_B(f(q), a) = f(q')
  *
+ * Both automata are first converted to DenseDFA so that the synchronized
+ * BFS below does array lookups only.  A transition that is undefined in
+ * both automata is consistent; one that is defined in only one is not.
+ *
  * @param A The first automaton.
  * @param B The second automaton.
  * @param mappingOut (optional) If not null, will be filled with the state
@@ -38,25 +43,36 @@ bool Automaton::isIsomorphic(const Automaton& A, const Automaton& B, map<int, in
         return false;
     }
 
-    // Retrieve the single start states from both automata.
-    int startA = *A.getInitialStates().begin();
-    int startB = *B.getInitialStates().begin();
+    DenseDFA DA = DenseDFA::fromAutomaton(A);
+    DenseDFA DB = DenseDFA::fromAutomaton(B);
+
+    // The tables must have the same columns for a column-wise comparison.
+    if (DA.getSymbols() != DB.getSymbols() || DA.size() != DB.size()) {
+        return false;
+    }
+
+    const uint32_t NONE = DenseDFA::NONE;
+    uint32_t k = DA.alphabetSize();
 
-    // These maps store the bijective mapping between states:
+    // These arrays store the bijective mapping between dense states:
     // mappingAB : A → B
     // mappingBA : B → A
-    map<int, int> mappingAB;
-    map<int, int> mappingBA;
+    vector<uint32_t> mappingAB(DA.size(), NONE);
+    vector<uint32_t> mappingBA(DB.size(), NONE);
+    uint32_t mapped = 0;
 
     // We perform a BFS (Breadth-First Search) starting from the pair
     // (startA, startB). The BFS ensures we explore corresponding states
     // in both automata in a synchronized way.
-    queue<pair<int, int>> q;
-    q.push({startA, startB});
+    queue<pair<uint32_t, uint32_t>> q;
 
-    // Initialize the mappings with the initial states.
+    uint32_t startA = DA.getInitial();
+    uint32_t startB = DB.getInitial();
+
+    q.push({startA, startB});
     mappingAB[startA] = startB;
     mappingBA[startB] = startA;
+    mapped++;
 
     // BFS traversal loop
     while (!q.empty()) {
@@ -64,43 +80,33 @@ bool Automaton::isIsomorphic(const Automaton& A, const Automaton& B, map<int, in
         q.pop();
 
         // Step 3: The "final" status of corresponding states must match.
-        bool aFinal = A.getFinalStates().count(a);
-        bool bFinal = B.getFinalStates().count(b);
-
-        if (aFinal != bFinal) {
-            // If one state is final and the other is not, not isomorphic.
+        if (DA.isFinal(a) != DB.isFinal(b)) {
             return false;
         }
 
         // Step 4: Check all transitions for every symbol in the alphabet.
-        for (char c : A.getAlphabet()) {
-            const auto& Atrans = A.getTransitions();
-            const auto& Btrans = B.getTransitions();
+        for (uint32_t c = 0; c < k; c++) {
+            uint32_t toA = DA.next(a, c);
+            uint32_t toB = DB.next(b, c);
 
-            // Find transitions (a, c) → ?
-            auto itA = Atrans.find({a, c});
-            auto itB = Btrans.find({b, c});
-
-            // Both automata must have a defined transition for this symbol.
-            if (itA == Atrans.end() || itB == Btrans.end()) {
+            // Defined in one automaton only → not isomorphic.
+            if ((toA == NONE) != (toB == NONE)) {
                 return false;
             }
-
-            // Since this is a DFA, each transition leads to exactly one state.
-            int toA = *itA->second.begin();
-            int toB = *itB->second.begin();
+            if (toA == NONE) continue;
 
             // Step 5: If these target states have not yet been mapped,
             // create a new correspondence and continue BFS.
-            if (!mappingAB.count(toA) && !mappingBA.count(toB)) {
+            if (mappingAB[toA] == NONE && mappingBA[toB] == NONE) {
                 mappingAB[toA] = toB;
                 mappingBA[toB] = toA;
+                mapped++;
 
                 q.push({toA, toB});
             }
             // Step 6: If already mapped, check consistency:
             // the existing mapping must agree with this transition.
-            else if (mappingAB.count(toA) && mappingAB[toA] != toB) {
+            else if (mappingAB[toA] != toB || mappingBA[toB] != toA) {
                 // Inconsistent mapping → not isomorphic.
                 return false;
             }
@@ -109,14 +115,17 @@ bool Automaton::isIsomorphic(const Automaton& A, const Automaton& B, map<int, in
 
     // Step 7: After BFS, every state in A must have a corresponding state in B,
     // and vice versa (bijective mapping).
-    if (mappingAB.size() != A.getStates().size() ||
-        mappingBA.size() != B.getStates().size()) {
+    if (mapped != DA.size()) {
         return false;
     }
 
-    // Step 8: If user provided an output pointer, return the found mapping.
+    // Step 8: If user provided an output pointer, return the found mapping
+    // in terms of the original state ids.
     if (mappingOut != nullptr) {
-        *mappingOut = mappingAB;
+        mappingOut->clear();
+        for (uint32_t s = 0; s < DA.size(); s++) {
+            (*mappingOut)[DA.stateId(s)] = DB.stateId(mappingAB[s]);
+        }
     }
 
     // If we reach here, all checks passed — automata are isomorphic.
@@ -0,0 +1,106 @@
+#include "../include/LazyDFA.h"
+
+using namespace std;
+
+LazyDFA::LazyDFA(const Automaton& A, size_t memoryBudget)
+    : nfa(A.freeze()),
+      closure(nfa),
+      n(nfa.size()),
+      k(nfa.alphabetSize()),
+      budget(memoryBudget),
+      table(n),
+      initialSet(n),
+      finalMask(n),
+      current(n),
+      successor(n) {
+
+    for (uint32_t q : nfa.getInitialStates()) closure.addTo(q, initialSet);
+
+    for (uint32_t q = 0; q < n; q++) {
+        if (nfa.isFinal(q)) finalMask.insert(q);
+    }
+}
+
+/**
+ * @brief Bytes of cached data: per state, its subset words, fingerprint,
+ *        two hash slots (load ≤ 1/2), transition row and final flag.
+ *
+ * Allocations are kept across flushes, so the process footprint stays
+ * close to the budget rather than to this figure.
+ */
+size_t LazyDFA::memoryUsage() const {
+    size_t perState = current.numWords() * sizeof(uint64_t) + sizeof(uint64_t) +
+                      2 * sizeof(uint32_t) + k * sizeof(uint32_t) + 1;
+    return (size_t)table.size() * perState;
+}
+
+/**
+ * @brief Drops every cached state and transition.
+ */
+void LazyDFA::flush() {
+    table.clear();
+    next.clear();
+    finals.clear();
+    startState = UNKNOWN;
+    flushes++;
+}
+
+uint32_t LazyDFA::intern(const StateSet& S) {
+    if (S.empty()) return DEAD;
+
+    bool inserted;
+    uint32_t id = table.intern(S, inserted);
+
+    if (inserted) {
+        next.resize(next.size() + k, UNKNOWN);
+        finals.push_back(S.intersects(finalMask) ? 1 : 0);
+    }
+
+    return id;
+}
+
+uint32_t LazyDFA::start() {
+    if (startState == UNKNOWN) startState = intern(initialSet);
+    return startState;
+}
+
+/**
+ * @brief Slow path of step(): builds ε-closure(δ(S, symbols[col])).
+ *
+ * @details
+ * If the cache is over budget, it is flushed first and the source subset
+ * is re-interned, so the new transition is still recorded.
+ */
+uint32_t LazyDFA::computeNext(uint32_t state, uint32_t col) {
+    table.load(state, current);
+
+    successor.clear();
+    current.forEach([&](uint32_t q) {
+        uint32_t e = nfa.findEdge(q, col);
+        if (e == CSRAutomaton::NONE) return;
+
+        for (const uint32_t* t = nfa.targetsBegin(e); t != nfa.targetsEnd(e); ++t) {
+            closure.addTo(*t, successor);
+        }
+    });
+
+    if (memoryUsage() > budget) {
+        flush();
+        state = intern(current);
+    }
+
+    uint32_t target = intern(successor);
+    next[(size_t)state * k + col] = target;
+    return target;
+}
+
+bool LazyDFA::accepts(string_view input) {
+    uint32_t s = start();
+
+    for (char c : input) {
+        s = step(s, c);
+        if (s == DEAD) return false;
+    }
+
+    return isFinal(s);
+}
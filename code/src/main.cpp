@@ -1,10 +1,13 @@
 #include "../include/Automaton.h"
+#include "../include/BatchCLI.h"
 #include "../include/Dot.h"
 #include "../include/RegexENFA.h"
 #include "../include/NFAToRegex.h"
+#include "../include/RenderQueue.h"
 #include "../include/RegexUtils.h"
 #include "../include/minimizeRegexFile.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
@@ -24,13 +27,13 @@ Automaton createNonDeterministicAutomaton(const string& inputBaseName);
 
 void proposition313(const Automaton& nonDeterministicAutomaton, const string& inputBaseName);
 void brozozowskisAlgorithm(const Automaton& nonDeterministicAutomaton, const string& inputBaseName);
-void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName);
+Automaton minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName);
 
 void checkIsomorphism();
 void regexToMinimalDFA();
 void automatonToImage(const string& inputBaseName);
 void nfaToRegex();
-void standardizeRegex();
+void standardizeRegex(RegexConstruction construction = RegexConstruction::Thompson);
 
 /*
  * main()
@@ -40,12 +43,32 @@ void standardizeRegex();
  * to the appropriate feature. The loop terminates when the user
  * selects option 0.
  *
+ * With command-line arguments the menu is skipped and the batch mode
+ * (runBatch, batchCLI.cpp) processes the given files instead, e.g.
+ *
+ *     mtp minimize --algo=hopcroft --jobs=8 a.txt b.txt ...
+ *
+ * The environment variable MTP_ARTIFACTS (none | text | dot | png, default
+ * png) selects which intermediate files the pipeline stages write; see
+ * ArtifactPolicy in Dot.h.
+ *
  * Notes:
  *  - All heavy functionality is implemented in dedicated modules.
  *  - This file remains the high-level dispatcher only.
  *  - InputBaseName is reused for different operations.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    if (const char* artifacts = getenv("MTP_ARTIFACTS")) {
+        ArtifactPolicy policy;
+        if (Dot::parseArtifactPolicy(artifacts, policy)) {
+            Dot::setArtifactPolicy(policy);
+        } else {
+            cerr << "Ignoring MTP_ARTIFACTS=" << artifacts << " (expected none, text, dot or png)\n";
+        }
+    }
+
+    if (argc > 1) return runBatch(argc, argv);
+
     string inputBaseName;
 
     while (true) {
@@ -71,6 +94,9 @@ int main() {
          * 0 → exit the program.
          */
         if (choice == 0) {
+            // Images are rendered in the background; let them finish.
+            RenderQueue::shared().waitAll();
+
             cout << "\n/////////////////////////\n";
             cout << "\nThank you for being here.\n";
             cout << "\n/////////////////////////\n";
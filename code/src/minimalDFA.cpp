@@ -29,14 +29,17 @@ using namespace std;
  *         ../../dots/min_<name>.dot
  *   - Renders a PNG image:
  *         ../../images/min_<name>.png
+ * each as far as the artifact policy allows (see Dot::writeArtifacts()).
  *
  * @param nonDeterministicAutomaton
  *        The input automaton (may be NFA or DFA).
  *
  * @param inputBaseName
  *        Base filename (no extension) used when constructing output filenames.
+ *
+ * @return The minimal DFA (also when the artifact policy writes no files).
  */
-void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName) {
+Automaton minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName) {
     // Output paths for the minimal DFA
     string outputFilePath    = "../../outputs/min_" + inputBaseName + ".txt";
     string outputDotFilePath = "../../dots/min_"  + inputBaseName + ".dot";
@@ -55,18 +58,13 @@ void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseNam
     Automaton minimized = Automaton::minimize(determinized);
 
     // ----------------------------------------------------------
-    // Step 3: Write minimized DFA to text file.
-    // ----------------------------------------------------------
-    minimized.writeAutomaton(outputFilePath);
-
-    // ----------------------------------------------------------
-    // Step 4: Generate DOT + PNG visualization.
+    // Step 3: Write minimized DFA to text file, and generate its
+    //         DOT + PNG visualization (as the artifact policy allows).
     // ----------------------------------------------------------
     Dot dotGenerator;
 
-    // Build DOT representation
-    dotGenerator.generateDot(outputFilePath, outputDotFilePath, "minimized");
+    dotGenerator.writeArtifacts(minimized, outputFilePath, outputDotFilePath,
+                                "minimized", "min_", inputBaseName);
 
-    // Render image using Graphviz
-    dotGenerator.generateImage(outputDotFilePath, "min_", inputBaseName);
+    return minimized;
 }
@@ -1,63 +1,50 @@
 #include "../include/Automaton.h"
+#include "../include/DenseDFA.h"
 
 #include <algorithm>
-#include <map>
-#include <queue>
-#include <set>
 #include <vector>
 
 using namespace std;
 
 /**
- * @brief Minimizes a deterministic finite automaton (DFA) using
- *        **partition refinement** (a classical DFA minimization algorithm).
+ * @brief Moore partition refinement over a dense DFA.
  *
  * @details
- * ### Theoretical Background
+ * Starts from the partition { non-final, final } and repeatedly splits
+ * every block by the signature
  *
- * Minimization constructs the **smallest DFA** (fewest states) that recognizes
- * the same language. Two states in a DFA are **equivalent** if, for every input
- * string, they both either accept or both reject.
+ *     sig(q) = ( block(δ(q, a₁)), block(δ(q, a₂)), ... )
  *
- * Partition refinement algorithm:
- *   1. Partition states into two sets:
- *        - Final states  (accepting)
- *        - Non-final states (rejecting)
- *
- *   2. Repeatedly split partitions:
- *      Two states belong in the same partition *only if* their transitions
- *      under every symbol lead into the same partitions.
+ * where a missing transition contributes -1.  Blocks are split in
+ * signature order and appended in that order, so block numbering is stable
+ * from run to run.
  *
- *   3. When no more splits occur, each partition represents **one state**
- *      in the minimized DFA, and all states in the same partition are
- *      formally equivalent.
+ * Each round costs O(n·|Σ| log n) thanks to the block index array
+ * (no scan over the partition list to locate a target's block).
  *
- * This algorithm is essentially Moore’s minimization algorithm.
- *
- * @param A  Deterministic automaton to be minimized.
- * @return   A new Automaton representing the minimal DFA equivalent to A.
+ * @param D         Dense DFA.
+ * @param numBlocks Receives the number of blocks in the final partition.
+ * @return          blockOf[q] for every dense state q.
  */
-Automaton Automaton::minimize(const Automaton& A) {
+static vector<uint32_t> mooreRefine(const DenseDFA& D, uint32_t& numBlocks) {
+    uint32_t n = D.size();
+    uint32_t k = D.alphabetSize();
 
     // ------------------------------------------------------------
-    // Step 1: Initial Partition — split into final / non-final.
+    // Step 1: Initial Partition — split into non-final / final.
     // ------------------------------------------------------------
-    set<int> nonFinalStates;
+    vector<vector<uint32_t>> partitions;
+    vector<uint32_t> nonFinalStates, finalStates;
 
-    for (int s : A.states) {
-        if (!A.finalStates.count(s)) {
-            nonFinalStates.insert(s);
-        }
+    for (uint32_t q = 0; q < n; q++) {
+        (D.isFinal(q) ? finalStates : nonFinalStates).push_back(q);
     }
 
-    // partitions[i] = a block of states that are currently considered equivalent
-    vector<set<int>> partitions;
-
-    if (!nonFinalStates.empty())
-        partitions.push_back(nonFinalStates);
+    if (!nonFinalStates.empty()) partitions.push_back(nonFinalStates);
+    if (!finalStates.empty())    partitions.push_back(finalStates);
 
-    if (!A.finalStates.empty())
-        partitions.push_back(A.finalStates);
+    vector<uint32_t> blockOf(n, 0);
+    vector<int> signature((size_t)n * k);
 
     // ------------------------------------------------------------
     // Step 2: Refinement loop
@@ -67,105 +54,324 @@ Automaton Automaton::minimize(const Automaton& A) {
 
     while (changed) {
         changed = false;
-        vector<set<int>> newPartitions;
 
-        // Process each partition separately
-        for (auto& part : partitions) {
-            
-            // A map: signature → subset of states having that signature.
-            // Signature identifies transition behavior of each state.
-            map<vector<int>, set<int>> splitter;
-
-            // Try splitting based on transitions under each alphabet symbol.
-            for (int state : part) {
-                vector<int> signature;
-
-                // Build the signature: for each symbol, record which partition
-                // the transition target belongs to.
-                for (char c : A.alphabet) {
-                    int targetPartitionIndex = -1;
-
-                    auto it = A.transitions.find({state, c});
-                    if (it != A.transitions.end()) {
-
-                        // Since this is a DFA, each transition has exactly one target.
-                        int to = *it->second.begin();
-
-                        // Find which partition the target state belongs to
-                        for (size_t i = 0; i < partitions.size(); i++) {
-                            if (partitions[i].count(to)) {
-                                targetPartitionIndex = (int)i;
-                                break;
-                            }
-                        }
-                    }
-
-                    // Push the index of the partition reached by symbol c
-                    signature.push_back(targetPartitionIndex);
-                }
+        for (uint32_t b = 0; b < partitions.size(); b++) {
+            for (uint32_t q : partitions[b]) blockOf[q] = b;
+        }
 
-                // Group states by signature
-                splitter[signature].insert(state);
+        // Build the signature of every state: for each symbol, the block
+        // reached by that symbol (or -1 if undefined).
+        for (uint32_t q = 0; q < n; q++) {
+            int* sig = signature.data() + (size_t)q * k;
+            for (uint32_t c = 0; c < k; c++) {
+                uint32_t to = D.next(q, c);
+                sig[c] = (to == DenseDFA::NONE) ? -1 : (int)blockOf[to];
             }
+        }
 
-            // If no split occurred (only one signature), push partition as-is.
-            if (splitter.size() == 1) {
-                newPartitions.push_back(part);
-            } 
-            else {
-                // A split occurred: different states have different signatures.
-                // Add each “piece” as a new partition.
-                for (auto& kv : splitter) {
-                    newPartitions.push_back(kv.second);
+        auto sigLess = [&](uint32_t x, uint32_t y) {
+            const int* sx = signature.data() + (size_t)x * k;
+            const int* sy = signature.data() + (size_t)y * k;
+            return lexicographical_compare(sx, sx + k, sy, sy + k);
+        };
+
+        vector<vector<uint32_t>> newPartitions;
+
+        // Group the states of each block by signature.
+        for (auto& part : partitions) {
+            stable_sort(part.begin(), part.end(), sigLess);
+
+            size_t start = newPartitions.size();
+            newPartitions.push_back({part[0]});
+
+            for (size_t i = 1; i < part.size(); i++) {
+                if (sigLess(part[i - 1], part[i])) {
+                    newPartitions.push_back({});
                 }
-                changed = true;
+                newPartitions.back().push_back(part[i]);
             }
+
+            if (newPartitions.size() - start > 1) changed = true;
         }
 
-        // Update partitions after refinement iteration
-        partitions = newPartitions;
+        partitions.swap(newPartitions);
+    }
+
+    for (uint32_t b = 0; b < partitions.size(); b++) {
+        for (uint32_t q : partitions[b]) blockOf[q] = b;
     }
 
+    numBlocks = (uint32_t)partitions.size();
+    return blockOf;
+}
+
+/**
+ * @brief Hopcroft partition refinement over a dense DFA.
+ *
+ * @details
+ * The partition is kept in a single permutation array `elems`: block b
+ * occupies elems[first[b] .. end[b]), and loc[q] is q's position, so a
+ * state can be moved to the front of its block in O(1).
+ *
+ * The worklist holds (block, symbol) splitters.  Popping (B, a) marks every
+ * a-predecessor of B, moving it to the front of its block; every touched
+ * block X that is only partly marked splits into X∖pre and X∩pre.  For each
+ * symbol, if (X, ·) is still pending the new part is added as well,
+ * otherwise only the smaller of the two parts is — the "smaller half" rule
+ * that bounds the work by O(n·|Σ|·log n).
+ *
+ * Partial DFAs are completed with one virtual sink state (index n) that is
+ * not reported back.  Blocks are finally numbered in order of their
+ * smallest state, so the numbering is deterministic.
+ *
+ * @param D         Dense DFA.
+ * @param numBlocks Receives the number of blocks containing real states.
+ * @return          blockOf[q] for every dense state q.
+ */
+static vector<uint32_t> hopcroftRefine(const DenseDFA& D, uint32_t& numBlocks) {
+    const uint32_t NONE = DenseDFA::NONE;
+    uint32_t n = D.size();
+    uint32_t k = D.alphabetSize();
+
+    // ------------------------------------------------------------
+    // Step 1: Complete the automaton with a virtual sink if needed.
+    // ------------------------------------------------------------
+    bool needSink = !D.isComplete();
+    uint32_t N = n + (needSink ? 1 : 0);
+    uint32_t sink = n;
+
+    auto target = [&](uint32_t q, uint32_t c) {
+        if (q == sink) return sink;
+        uint32_t t = D.next(q, c);
+        return t == NONE ? sink : t;
+    };
+
     // ------------------------------------------------------------
-    // Step 3: Build the minimized DFA.
-    // Each partition becomes one state in the new DFA.
+    // Step 2: Inverse transitions, one CSR per symbol:
+    //         pred[c][ predOffsets[c*(N+1) + t] .. ) = { p | δ(p,c) = t }
     // ------------------------------------------------------------
-    Automaton M;
-    map<int, int> stateToPartition;
+    vector<uint32_t> predOffsets((size_t)k * (N + 1) + 1, 0);
+    vector<uint32_t> preds((size_t)N * k);
+
+    for (uint32_t c = 0; c < k; c++) {
+        uint32_t* off = predOffsets.data() + (size_t)c * (N + 1);
+        for (uint32_t p = 0; p < N; p++) off[target(p, c) + 1]++;
+        for (uint32_t t = 0; t < N; t++) off[t + 1] += off[t];
+
+        vector<uint32_t> cursor(off, off + N);
+        uint32_t* out = preds.data() + (size_t)c * N;
+        for (uint32_t p = 0; p < N; p++) out[cursor[target(p, c)]++] = p;
+    }
 
-    // Assign each partition an integer ID (0,1,2,...)
-    for (size_t i = 0; i < partitions.size(); i++) {
-        for (int s : partitions[i]) {
-            stateToPartition[s] = (int)i;
+    auto predBegin = [&](uint32_t c, uint32_t t) {
+        return preds.data() + (size_t)c * N + predOffsets[(size_t)c * (N + 1) + t];
+    };
+    auto predEnd = [&](uint32_t c, uint32_t t) {
+        return preds.data() + (size_t)c * N + predOffsets[(size_t)c * (N + 1) + t + 1];
+    };
+
+    // ------------------------------------------------------------
+    // Step 3: Initial partition { non-final, final }.
+    // ------------------------------------------------------------
+    vector<uint32_t> elems, loc(N), blockOf(N);
+    vector<uint32_t> first, end, marked;
+    elems.reserve(N);
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool wantFinal = (pass == 1);
+        uint32_t start = (uint32_t)elems.size();
+
+        for (uint32_t q = 0; q < N; q++) {
+            bool fin = (q < n) && D.isFinal(q);
+            if (fin != wantFinal) continue;
+            loc[q] = (uint32_t)elems.size();
+            blockOf[q] = (uint32_t)first.size();
+            elems.push_back(q);
+        }
+
+        if (elems.size() > start) {
+            first.push_back(start);
+            end.push_back((uint32_t)elems.size());
+            marked.push_back(0);
         }
-        M.states.insert((int)i);
     }
 
-    // Initial states: map each original initial state to its partition
-    for (int s : A.initialStates) {
-        M.initialStates.insert(stateToPartition[s]);
+    // ------------------------------------------------------------
+    // Step 4: Worklist of (block, symbol) splitters.
+    // ------------------------------------------------------------
+    vector<pair<uint32_t, uint32_t>> worklist;
+    vector<uint8_t> inWorklist((size_t)N * k, 0);   // indexed block*k + c
+
+    auto push = [&](uint32_t b, uint32_t c) {
+        inWorklist[(size_t)b * k + c] = 1;
+        worklist.push_back({b, c});
+    };
+
+    if (first.size() == 2) {
+        uint32_t smaller = (end[0] - first[0] <= end[1] - first[1]) ? 0 : 1;
+        for (uint32_t c = 0; c < k; c++) push(smaller, c);
     }
 
-    // Final states: if any original final state sits in partition P,
-    // then P is final
-    for (int s : A.finalStates) {
-        M.finalStates.insert(stateToPartition[s]);
+    vector<uint32_t> touched, splitter;
+
+    while (!worklist.empty()) {
+        auto [B, c] = worklist.back();
+        worklist.pop_back();
+        inWorklist[(size_t)B * k + c] = 0;
+
+        // Snapshot B: marking may permute the elements of B itself.
+        splitter.assign(elems.begin() + first[B], elems.begin() + end[B]);
+
+        // Step 4a: mark every c-predecessor of B.
+        touched.clear();
+        for (uint32_t q : splitter) {
+
+            for (const uint32_t* it = predBegin(c, q); it != predEnd(c, q); ++it) {
+                uint32_t p = *it;
+                uint32_t X = blockOf[p];
+                uint32_t dest = first[X] + marked[X];
+
+                if (loc[p] < dest) continue;   // already marked
+                if (marked[X] == 0) touched.push_back(X);
+
+                // Swap p to the front (marked part) of its block.
+                uint32_t other = elems[dest];
+                elems[dest] = p;
+                elems[loc[p]] = other;
+                loc[other] = loc[p];
+                loc[p] = dest;
+                marked[X]++;
+            }
+        }
+
+        // Step 4b: split every partly-marked block.
+        for (uint32_t X : touched) {
+            uint32_t m = marked[X];
+            marked[X] = 0;
+
+            if (m == end[X] - first[X]) continue;   // wholly marked: no split
+
+            uint32_t Y = (uint32_t)first.size();
+            first.push_back(first[X]);
+            end.push_back(first[X] + m);
+            marked.push_back(0);
+            first[X] += m;
+
+            for (uint32_t i = first[Y]; i < end[Y]; i++) blockOf[elems[i]] = Y;
+
+            uint32_t sizeX = end[X] - first[X];
+            uint32_t sizeY = end[Y] - first[Y];
+
+            for (uint32_t a = 0; a < k; a++) {
+                if (inWorklist[(size_t)X * k + a]) {
+                    push(Y, a);
+                } else {
+                    push(sizeY <= sizeX ? Y : X, a);
+                }
+            }
+        }
     }
 
     // ------------------------------------------------------------
-    // Step 4: Build transitions of minimized DFA
+    // Step 5: Number the blocks of real states by smallest member.
     // ------------------------------------------------------------
-    for (auto& p : A.transitions) {
-        int from = p.first.first;
-        char symbol = p.first.second;
-        int to = *p.second.begin();   // DFA: single transition target
+    vector<uint32_t> number(first.size(), NONE);
+    vector<uint32_t> result(n);
+    numBlocks = 0;
+
+    for (uint32_t q = 0; q < n; q++) {
+        uint32_t b = blockOf[q];
+        if (number[b] == NONE) number[b] = numBlocks++;
+        result[q] = number[b];
+    }
 
-        int newFrom = stateToPartition[from];
-        int newTo   = stateToPartition[to];
+    return result;
+}
 
-        M.transitions[{newFrom, symbol}].insert(newTo);
-        M.alphabet.insert(symbol);
+/**
+ * @brief Builds the quotient DFA D / ≡ from a block assignment.
+ *
+ * Each block becomes one state; since all states of a block have the same
+ * signature, any member's row determines the block's row.
+ */
+static DenseDFA quotient(const DenseDFA& D, const vector<uint32_t>& blockOf, uint32_t numBlocks) {
+    uint32_t k = D.alphabetSize();
+
+    DenseDFA M(numBlocks, D.getSymbols());
+    M.setAlphabet(D.getAlphabet());
+
+    for (uint32_t q = 0; q < D.size(); q++) {
+        uint32_t b = blockOf[q];
+
+        for (uint32_t c = 0; c < k; c++) {
+            uint32_t to = D.next(q, c);
+            if (to != DenseDFA::NONE) M.setNext(b, c, blockOf[to]);
+        }
+
+        if (D.isFinal(q)) M.setFinal(b);
+    }
+
+    if (D.getInitial() != DenseDFA::NONE) {
+        M.setInitial(blockOf[D.getInitial()]);
     }
 
     return M;
 }
+
+/**
+ * @brief Minimizes a deterministic finite automaton (DFA) using
+ *        **partition refinement** (a classical DFA minimization algorithm).
+ *
+ * @details
+ * ### Theoretical Background
+ *
+ * Minimization constructs the **smallest DFA** (fewest states) that recognizes
+ * the same language. Two states in a DFA are **equivalent** if, for every input
+ * string, they both either accept or both reject.
+ *
+ * Partition refinement algorithm:
+ *   1. Partition states into two sets:
+ *        - Final states  (accepting)
+ *        - Non-final states (rejecting)
+ *
+ *   2. Repeatedly split partitions:
+ *      Two states belong in the same partition *only if* their transitions
+ *      under every symbol lead into the same partitions.
+ *
+ *   3. When no more splits occur, each partition represents **one state**
+ *      in the minimized DFA, and all states in the same partition are
+ *      formally equivalent.
+ *
+ * Three refinement strategies are available (see MinimizationAlgorithm):
+ * Moore's round-based algorithm, Hopcroft's worklist algorithm (the
+ * default), and Valmari–Lehtinen for partial DFAs (minimizePartial.cpp).
+ *
+ * @param A          Deterministic automaton to be minimized.
+ * @param algorithm  Refinement strategy.
+ * @return   A new Automaton representing the minimal DFA equivalent to A.
+ */
+Automaton Automaton::minimize(const Automaton& A, MinimizationAlgorithm algorithm) {
+
+    // Partial-DFA minimization works on the sparse form, not the table.
+    if (algorithm == MinimizationAlgorithm::ValmariLehtinen) {
+        return minimizePartial(A);
+    }
+
+    // ------------------------------------------------------------
+    // Step 1: Move to the flat transition table.
+    // ------------------------------------------------------------
+    DenseDFA D = DenseDFA::fromAutomaton(A);
+
+    // ------------------------------------------------------------
+    // Step 2: Partition refinement.
+    // ------------------------------------------------------------
+    uint32_t numBlocks = 0;
+    vector<uint32_t> blockOf = (algorithm == MinimizationAlgorithm::Moore)
+                                 ? mooreRefine(D, numBlocks)
+                                 : hopcroftRefine(D, numBlocks);
+
+    // ------------------------------------------------------------
+    // Step 3: Each partition becomes one state in the new DFA.
+    // ------------------------------------------------------------
+    return quotient(D, blockOf, numBlocks).toAutomaton();
+}
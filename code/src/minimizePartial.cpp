@@ -0,0 +1,282 @@
+#include "../include/Automaton.h"
+#include "../include/CSRAutomaton.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Refinable partition of 0 .. n-1, as used by Valmari and Lehtinen.
+ *
+ * @details
+ * Elements of set s occupy the contiguous range
+ *
+ *     elems[ first[s] , past[s] )
+ *
+ * and loc[] is the inverse of elems[].  Marking an element swaps it to the
+ * front of its set, so splitting a set is O(#marked): the marked prefix and
+ * the unmarked suffix become two sets, and the smaller one gets the new
+ * index (the larger keeps the old one).
+ */
+struct RefinablePartition {
+    uint32_t numSets = 0;
+    vector<uint32_t> elems, loc, setOf, first, past;
+    vector<uint32_t> marked;    ///< Number of marked elements per set
+    vector<uint32_t> touched;   ///< Sets with at least one marked element
+
+    explicit RefinablePartition(uint32_t n)
+        : numSets(n > 0 ? 1 : 0),
+          elems(n), loc(n), setOf(n, 0),
+          first(n, 0), past(n, 0), marked(n + 1, 0) {
+        for (uint32_t i = 0; i < n; i++) elems[i] = loc[i] = i;
+        if (n > 0) past[0] = n;
+    }
+
+    void mark(uint32_t e) {
+        uint32_t s = setOf[e];
+        uint32_t i = loc[e];
+        uint32_t j = first[s] + marked[s];
+
+        elems[i] = elems[j]; loc[elems[i]] = i;
+        elems[j] = e;        loc[e] = j;
+
+        if (marked[s]++ == 0) touched.push_back(s);
+    }
+
+    void split() {
+        while (!touched.empty()) {
+            uint32_t s = touched.back();
+            touched.pop_back();
+
+            uint32_t j = first[s] + marked[s];
+            if (j == past[s]) {             // every element marked
+                marked[s] = 0;
+                continue;
+            }
+
+            uint32_t z = numSets++;
+            if (marked[s] <= past[s] - j) { // marked part is the smaller
+                first[z] = first[s];
+                past[z] = first[s] = j;
+            } else {
+                past[z] = past[s];
+                first[z] = past[s] = j;
+            }
+
+            for (uint32_t i = first[z]; i < past[z]; i++) setOf[elems[i]] = z;
+            marked[s] = marked[z] = 0;
+        }
+    }
+};
+
+/**
+ * @brief Minimizes a partial DFA with the Valmari–Lehtinen algorithm.
+ *
+ * @details
+ * States and transitions are both kept in refinable partitions: blocks of
+ * states and "cords" of transitions (initially one cord per symbol).  The
+ * algorithm alternates
+ *
+ *   - split blocks by the tails of a cord's transitions, and
+ *   - split cords by the heads lying in a newly created block,
+ *
+ * touching only defined transitions.  No dead state is ever introduced, so
+ * the cost is O(n + m·log n) for m defined transitions, independent of
+ * |Σ|·n.
+ *
+ * Before refinement the automaton is trimmed: states unreachable from the
+ * initial state, or from which no final state is reachable, are removed.
+ * The result is therefore the minimal *partial* DFA; if the language is
+ * empty it is a single non-final initial state.
+ *
+ * Blocks are renumbered 0 .. k-1 by their smallest original state, so the
+ * output is stable from run to run.
+ *
+ * @param A Deterministic (possibly partial) automaton.
+ * @return  The minimal trim DFA equivalent to A.
+ */
+Automaton Automaton::minimizePartial(const Automaton& A) {
+    const CSRAutomaton& C = A.freeze();
+    uint32_t n = C.size();
+
+    Automaton M;
+    M.alphabet = A.alphabet;
+
+    if (C.getInitialStates().empty()) return M;
+    uint32_t q0 = C.getInitialStates().front();
+
+    // ------------------------------------------------------------
+    // Step 1: Flatten δ into (tail, label, head) arrays.
+    // ------------------------------------------------------------
+    vector<uint32_t> tail, label, head;
+    tail.reserve(C.numEdges());
+    label.reserve(C.numEdges());
+    head.reserve(C.numEdges());
+
+    for (uint32_t q = 0; q < n; q++) {
+        for (uint32_t e = C.edgeBegin(q); e < C.edgeEnd(q); e++) {
+            tail.push_back(q);
+            label.push_back(C.edgeColumn(e));
+            head.push_back(*C.targetsBegin(e));
+        }
+    }
+
+    uint32_t m = (uint32_t)tail.size();
+
+    // ------------------------------------------------------------
+    // Step 2: Trim.  Reached states are swapped to the front of
+    // block 0; transitions whose tail was not reached are dropped.
+    // ------------------------------------------------------------
+    RefinablePartition B(n);
+    vector<uint32_t> adjacent(m), offset(n + 1);
+    uint32_t reached = 0;
+
+    auto makeAdjacent = [&](const vector<uint32_t>& key) {
+        fill(offset.begin(), offset.end(), 0);
+        for (uint32_t t = 0; t < m; t++) offset[key[t]]++;
+        for (uint32_t q = 0; q < n; q++) offset[q + 1] += offset[q];
+        for (uint32_t t = m; t-- > 0; ) adjacent[--offset[key[t]]] = t;
+    };
+
+    auto reach = [&](uint32_t q) {
+        uint32_t i = B.loc[q];
+        if (i >= reached) {
+            B.elems[i] = B.elems[reached]; B.loc[B.elems[i]] = i;
+            B.elems[reached] = q;          B.loc[q] = reached++;
+        }
+    };
+
+    auto removeUnreached = [&](vector<uint32_t>& from, vector<uint32_t>& to) {
+        makeAdjacent(from);
+        for (uint32_t i = 0; i < reached; i++) {
+            uint32_t q = B.elems[i];
+            for (uint32_t j = offset[q]; j < offset[q + 1]; j++) {
+                reach(to[adjacent[j]]);
+            }
+        }
+
+        uint32_t kept = 0;
+        for (uint32_t t = 0; t < m; t++) {
+            if (B.loc[from[t]] < reached) {
+                tail[kept] = tail[t]; label[kept] = label[t]; head[kept] = head[t];
+                kept++;
+            }
+        }
+        m = kept;
+        B.past[0] = reached;
+        reached = 0;
+    };
+
+    reach(q0);
+    removeUnreached(tail, head);        // forward from q0
+
+    for (uint32_t q = 0; q < n; q++) {
+        if (C.isFinal(q) && B.loc[q] < B.past[0]) reach(q);
+    }
+    uint32_t numFinal = reached;
+    removeUnreached(head, tail);        // backward from F
+
+    if (numFinal == 0) {
+        // Empty language: one rejecting initial state.
+        M.addState(0);
+        M.addInitialState(0);
+        return M;
+    }
+
+    // ------------------------------------------------------------
+    // Step 3: Initial block partition { F , Q \ F }.  Final states
+    // were reached first in the backward pass, so they form the
+    // prefix of block 0.
+    // ------------------------------------------------------------
+    B.marked[0] = numFinal;
+    B.touched.push_back(0);
+    B.split();
+
+    // ------------------------------------------------------------
+    // Step 4: Initial cord partition — one cord per label.
+    // ------------------------------------------------------------
+    RefinablePartition T(m);
+    if (m > 0) {
+        stable_sort(T.elems.begin(), T.elems.end(), [&](uint32_t x, uint32_t y) {
+            return label[x] < label[y];
+        });
+
+        T.numSets = 0;
+        T.first[0] = 0;
+        uint32_t a = label[T.elems[0]];
+
+        for (uint32_t i = 0; i < m; i++) {
+            uint32_t t = T.elems[i];
+            if (label[t] != a) {
+                a = label[t];
+                T.past[T.numSets++] = i;
+                T.first[T.numSets] = i;
+            }
+            T.setOf[t] = T.numSets;
+            T.loc[t] = i;
+        }
+        T.past[T.numSets++] = m;
+    }
+
+    // ------------------------------------------------------------
+    // Step 5: Alternate splitting blocks by cords and cords by
+    // blocks until neither changes.  Block 0 never needs to act as
+    // a splitter (it is the complement of all the others).
+    // ------------------------------------------------------------
+    makeAdjacent(head);
+
+    uint32_t b = 1, c = 0;
+    while (c < T.numSets) {
+        for (uint32_t i = T.first[c]; i < T.past[c]; i++) {
+            B.mark(tail[T.elems[i]]);
+        }
+        B.split();
+        c++;
+
+        while (b < B.numSets) {
+            for (uint32_t i = B.first[b]; i < B.past[b]; i++) {
+                uint32_t q = B.elems[i];
+                for (uint32_t j = offset[q]; j < offset[q + 1]; j++) {
+                    T.mark(adjacent[j]);
+                }
+            }
+            T.split();
+            b++;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Step 6: Renumber blocks by smallest original state and build
+    // the quotient from one representative per block.
+    // ------------------------------------------------------------
+    uint32_t live = B.past[0];
+    for (uint32_t s = 1; s < B.numSets; s++) live = max(live, B.past[s]);
+
+    vector<uint32_t> newId(B.numSets, CSRAutomaton::NONE);
+    uint32_t numBlocks = 0;
+
+    for (uint32_t q = 0; q < n; q++) {
+        if (B.loc[q] >= live) continue;     // trimmed away
+        uint32_t s = B.setOf[q];
+        if (newId[s] == CSRAutomaton::NONE) newId[s] = numBlocks++;
+    }
+
+    for (uint32_t s = 0; s < numBlocks; s++) M.addState((int)s);
+
+    for (uint32_t s = 0; s < B.numSets; s++) {
+        if (B.first[s] < numFinal) M.addFinalState((int)newId[s]);
+    }
+
+    M.addInitialState((int)newId[B.setOf[q0]]);
+
+    const string& symbols = C.getSymbols();
+    for (uint32_t t = 0; t < m; t++) {
+        uint32_t q = tail[t];
+        if (B.loc[q] != B.first[B.setOf[q]]) continue;  // not the representative
+        M.addTransition((int)newId[B.setOf[q]], symbols[label[t]],
+                        (int)newId[B.setOf[head[t]]]);
+    }
+
+    return M;
+}
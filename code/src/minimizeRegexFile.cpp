@@ -2,6 +2,7 @@
 #include "../include/RegexUtils.h"
 #include "../include/Automaton.h"
 #include "../include/RegexENFA.h"
+#include "../include/RegexParser.h"
 #include "../include/Dot.h"
 
 #include <iostream>
@@ -14,7 +15,7 @@ using namespace std;
  * minimizeRegexFromFile()
  *
  * Reads a regular expression from a .txt file in the inputs directory,
- * minimizes it using the complete regex→ENFA→NFA→DFA→minDFA→regex pipeline,
+ * minimizes it using the complete regex→ENFA→DFA→minDFA→regex pipeline,
  * writes the minimized regex to the outputs directory, and also generates
  * an image of the minimal DFA corresponding to the minimized regex.
  *
@@ -62,49 +63,34 @@ void minimizeRegexFromFile() {
     cout << "\nMinimized regex written to: " << outputPath << endl;
 
     /*
-     * Step 4: Write minimized regex into a temporary file so that
-     * regexToENFA() and related modules (which expect filenames)
-     * can be reused without modifying their interfaces.
+     * Step 4: Parse the minimized regex back into an AST
      */
-    string tmpRegexBase = "tmp_minimized_regex";
-    string tmpRegexPath = "../../inputs/" + tmpRegexBase + ".txt";
-
-    {
-        ofstream tmp(tmpRegexPath);
-        if (!tmp.is_open()) {
-            cout << "Error: Could not write temporary regex file " << tmpRegexPath << endl;
-            return;
-        }
-        tmp << minimized;
-        tmp.close();
-    }
+    auto minimizedAst = parseRegexToAST(minimized);
 
     /*
-     * Step 5: Run minimized regex through the automata pipeline:
-     *         regex → ENFA → NFA → DFA → minimal DFA
+     * Step 5: Run minimized regex through the automata pipeline, in memory:
+     *         regex → ENFA → DFA → minimal DFA
+     *         (determinise() follows the ε-transitions itself)
      */
-    Automaton enfa = regexToENFA(tmpRegexBase);
-    Automaton nfa  = eNFAtoNFA(tmpRegexBase);
+    Automaton enfa = regexToENFA(*minimizedAst);
 
-    Automaton dfa    = Automaton::determinise(nfa);
+    Automaton dfa    = Automaton::determinise(enfa);
     Automaton minDFA = Automaton::minimize(dfa);
 
     /*
-     * Step 6: Write minimal DFA to outputs directory
+     * Step 6: Write minimal DFA to outputs directory, with its DOT + PNG
+     *         image (as far as the artifact policy allows)
      */
     string autoOut = "../../outputs/min_regex_automaton_" + regexBaseName + ".txt";
-    minDFA.writeAutomaton(autoOut);
-
-    /*
-     * Step 7: Generate DOT + PNG image of the minimal DFA
-     */
-    string dotOut = "../../dots/min_regex_automaton_" + regexBaseName + ".dot";
+    string dotOut  = "../../dots/min_regex_automaton_" + regexBaseName + ".dot";
 
     Dot dotGen;
-    dotGen.generateDot(autoOut, dotOut, "MinRegexDFA");
-    dotGen.generateImage(dotOut, "min_regex_automaton_", regexBaseName);
+    dotGen.writeArtifacts(minDFA, autoOut, dotOut, "MinRegexDFA",
+                          "min_regex_automaton_", regexBaseName);
 
-    cout << "Image generated at: ../../images/min_regex_automaton_" << regexBaseName << ".png\n";
+    if (Dot::artifactPolicy() == ArtifactPolicy::Png) {
+        cout << "Image generated at: ../../images/min_regex_automaton_" << regexBaseName << ".png\n";
+    }
 
     /*
      * Console reporting of the minimized form
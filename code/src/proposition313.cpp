@@ -83,15 +83,11 @@ void proposition313(const Automaton& nonDeterministicAutomaton, const string& in
     Automaton deterministicAutomaton = Automaton::determinise(nonDeterministicAutomaton);
 
     // -----------------------------------------------------------------------
-    // Step 2: Write the determinized (and therefore minimal) automaton to file.
-    // -----------------------------------------------------------------------
-    deterministicAutomaton.writeAutomaton(outputTextFilePath);
-
-    // -----------------------------------------------------------------------
-    // Step 3: Visualization — DOT + PNG generation
+    // Step 2: Write the determinized (and therefore minimal) automaton to file,
+    //         with its DOT + PNG visualization (as the artifact policy allows).
     // -----------------------------------------------------------------------
     Dot dotGenerator;
 
-    dotGenerator.generateDot(outputTextFilePath, outputDotFilePath, "Proposition_313_MinimalDFA");
-    dotGenerator.generateImage(outputDotFilePath, "pro_", inputBaseName);
+    dotGenerator.writeArtifacts(deterministicAutomaton, outputTextFilePath, outputDotFilePath,
+                                "Proposition_313_MinimalDFA", "pro_", inputBaseName);
 }
@@ -1,8 +1,21 @@
 #include "../include/Automaton.h"
+#include "../include/ThreadPool.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <tuple>
 
 using namespace std;
 
@@ -31,8 +44,9 @@ using namespace std;
  *       f1 f2 ...
  *
  * Each section is followed by one or more lines of data, and an empty line
- * marks the end of that section. The parser ignores blank lines and reads
- * until EOF.
+ * (or one holding only whitespace) marks the end of that section. A section
+ * label also ends the section before it. The parser ignores blank lines and
+ * reads until EOF.
  *
  * Example:
  *    STATES:
@@ -61,101 +75,464 @@ using namespace std;
  *         transitions, initial states, and final states.
  *
  * @note
- * - No strict error validation is performed: malformed lines may produce
- *   partially parsed results.
+ * - The file is mapped (or read) whole and parsed by parseAutomaton();
+ *   malformed lines are skipped and reported on stderr as
+ *   "[ERROR] <file>:<line>: <message>".
  * - Alphabet symbols are assumed to be single characters.
  * - ε-transitions should be represented using '#' if applicable.
  */
-Automaton Automaton::readAutomaton(const string& filename) {
-    fstream fin(filename);
+namespace {
 
-    Automaton A;
+/**
+ * @brief A whole file in memory: mapped read-only when possible, read into
+ *        a string otherwise (pipes, empty files).
+ */
+class FileText {
+public:
+    explicit FileText(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        found = true;
 
-    string line;
-    string label;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, (size_t)info.st_size, MADV_SEQUENTIAL);
+                mapping = p;
+                mappingSize = (size_t)info.st_size;
+                close(fd);
+                return;
+            }
+        }
 
-    // ---------------------------------------------------------------------
-    // Read file line-by-line, using section labels to determine how lines
-    // should be interpreted.
-    // ---------------------------------------------------------------------
-    while (getline(fin, line)) {
-
-        if (line.empty())
-            continue;   // skip blank lines
-
-        stringstream ss(line);
-        ss >> label;
-
-        // --------------------------------------------------------------
-        // STATES:
-        // --------------------------------------------------------------
-        if (label == "STATES:") {
-            int s;
-            while (getline(fin, line) && !line.empty()) {
-                stringstream ss2(line);
-                while (ss2 >> s) {
-                    A.states.insert(s);
-                }
+        char buffer[1 << 16];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof buffer)) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
             }
+            copy.append(buffer, (size_t)n);
+        }
+        close(fd);
+    }
+
+    ~FileText() {
+        if (mapping) munmap(mapping, mappingSize);
+    }
+
+    FileText(const FileText&) = delete;
+    FileText& operator=(const FileText&) = delete;
+
+    bool exists() const {
+        return found;
+    }
+
+    string_view text() const {
+        if (mapping) return { (const char*)mapping, mappingSize };
+        return copy;
+    }
+
+private:
+    bool found = false;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    string copy;
+};
+
+/**
+ * @brief Prints the parse errors of source on stderr (the first few of
+ *        them, then a count).
+ */
+void reportErrors(const string& source, const vector<Automaton::ParseError>& errors) {
+    const size_t shown = 20;
+
+    for (size_t i = 0; i < errors.size() && i < shown; i++) {
+        cerr << "[ERROR] " << source << ":" << errors[i].line << ": " << errors[i].message << "\n";
+    }
+    if (errors.size() > shown) {
+        cerr << "[ERROR] " << source << ": " << (errors.size() - shown) << " more malformed line(s)\n";
+    }
+}
+
+enum class Section { None, States, Alphabet, Transitions, Initial, Final };
+
+Section sectionOf(string_view label) {
+    if (label == "STATES:")         return Section::States;
+    if (label == "ALPHABET:")       return Section::Alphabet;
+    if (label == "TRANSITIONS:")    return Section::Transitions;
+    if (label == "INITIAL_STATES:") return Section::Initial;
+    if (label == "FINAL_STATES:")   return Section::Final;
+    return Section::None;
+}
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Whitespace-separated tokens of one line.
+ */
+class Tokens {
+public:
+    Tokens(const char* begin, const char* end) : p(begin), end(end) {}
+
+    /// Next token, or an empty view at the end of the line.
+    string_view next() {
+        while (p < end && isBlank(*p)) p++;
+        const char* start = p;
+        while (p < end && !isBlank(*p)) p++;
+        return { start, (size_t)(p - start) };
+    }
+
+private:
+    const char* p;
+    const char* end;
+};
+
+/// Whole token as a state id; false if it is not one.
+bool parseState(string_view token, int& value) {
+    auto [ptr, ec] = from_chars(token.data(), token.data() + token.size(), value);
+    return ec == errc() && ptr == token.data() + token.size();
+}
+
+using Edge = tuple<int, char, int>;
+
+/**
+ * @brief One newline-aligned slice of a TRANSITIONS section and what was
+ *        parsed from it.
+ */
+struct Chunk {
+    const char* begin;
+    const char* end;
+
+    vector<Edge> edges;                     ///< Sorted
+    vector<pair<size_t, string>> errors;    ///< (line within chunk, message)
+    size_t lines = 0;                       ///< Lines parsed
+    const char* stop = nullptr;             ///< Line that ends the section, if here
+
+    Chunk(const char* begin, const char* end) : begin(begin), end(end) {}
+};
+
+/**
+ * @brief Parses transition lines of chunk until the end of the chunk or a
+ *        line that ends the section (blank, or a section label), then
+ *        sorts the edges.
+ */
+void parseTransitions(Chunk& chunk) {
+    const char* p = chunk.begin;
+
+    while (p < chunk.end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(chunk.end - p));
+        const char* lineEnd = newline ? newline : chunk.end;
+
+        Tokens tokens(p, lineEnd);
+        string_view from = tokens.next();
+        if (from.empty() || sectionOf(from) != Section::None) {
+            chunk.stop = p;
+            break;
         }
+        p = newline ? newline + 1 : chunk.end;
+
+        // Format: <from> <symbol> <to>
+        string_view symbol = tokens.next();
+        string_view to = tokens.next();
+        int u, v;
+
+        if (to.empty() || !tokens.next().empty() || symbol.size() != 1) {
+            chunk.errors.emplace_back(chunk.lines, "expected '<from> <symbol> <to>'");
+        } else if (!parseState(from, u)) {
+            chunk.errors.emplace_back(chunk.lines, "'" + string(from) + "' is not a state");
+        } else if (!parseState(to, v)) {
+            chunk.errors.emplace_back(chunk.lines, "'" + string(to) + "' is not a state");
+        } else {
+            chunk.edges.emplace_back(u, symbol[0], v);
+        }
+        chunk.lines++;
+    }
+
+    // Files written by writeAutomaton() are sorted already.
+    if (!is_sorted(chunk.edges.begin(), chunk.edges.end())) {
+        sort(chunk.edges.begin(), chunk.edges.end());
+    }
+}
+
+/// Sections smaller than this are parsed on the calling thread.
+constexpr size_t PARALLEL_MIN_BYTES = 16u << 20;
+
+/// Smallest chunk handed to a worker.
+constexpr size_t MIN_CHUNK_BYTES = 4u << 20;
+
+/**
+ * @brief Splits [begin, end) into chunks of about `size` bytes, each
+ *        ending just after a newline.
+ */
+vector<Chunk> splitLines(const char* begin, const char* end, size_t size) {
+    vector<Chunk> chunks;
+
+    while (begin < end) {
+        const char* cut = end;
+        if ((size_t)(end - begin) > size) {
+            const char* newline = (const char*)memchr(begin + size, '\n', (size_t)(end - begin - size));
+            if (newline) cut = newline + 1;
+        }
+        chunks.emplace_back(begin, cut);
+        begin = cut;
+    }
+    return chunks;
+}
+
+/**
+ * @brief Merges sorted runs pairwise, one round of merges in parallel,
+ *        until one run is left.
+ */
+vector<Edge> mergeRuns(vector<vector<Edge>> runs, ThreadPool& pool) {
+    while (runs.size() > 1) {
+        vector<vector<Edge>> merged((runs.size() + 1) / 2);
 
-        // --------------------------------------------------------------
-        // ALPHABET:
-        // --------------------------------------------------------------
-        else if (label == "ALPHABET:") {
-            char c;
-            while (getline(fin, line) && !line.empty()) {
-                stringstream ss2(line);
-                while (ss2 >> c) {
-                    A.alphabet.insert(c);
+        pool.parallelFor(merged.size(), 1, [&](size_t first, size_t last, unsigned) {
+            for (size_t i = first; i < last; i++) {
+                if (2 * i + 1 == runs.size()) {
+                    merged[i] = std::move(runs[2 * i]);
+                    continue;
                 }
+                vector<Edge>& a = runs[2 * i];
+                vector<Edge>& b = runs[2 * i + 1];
+
+                merged[i].resize(a.size() + b.size());
+                merge(a.begin(), a.end(), b.begin(), b.end(), merged[i].begin());
+                vector<Edge>().swap(a);
+                vector<Edge>().swap(b);
+            }
+        });
+        runs = std::move(merged);
+    }
+    return runs.empty() ? vector<Edge>() : std::move(runs[0]);
+}
+
+/**
+ * @brief Parses the body of a TRANSITIONS section that starts at begin.
+ *
+ * @details
+ * Sections of at least PARALLEL_MIN_BYTES (counting to the end of the
+ * text, since where the section ends is not known yet) are split into
+ * newline-aligned chunks that the pool parses and sorts concurrently.
+ * Every chunk stops at the first line ending the section; chunks after
+ * the first such line are skipped, or dropped if already parsed.
+ *
+ * The sorted edges of each chunk are appended to runs, the errors to
+ * errors with file line numbers.
+ *
+ * @param lineNumber Line of the label; advanced past the section body.
+ * @return Start of the line that ended the section, or end.
+ */
+const char* parseTransitionSection(const char* begin, const char* end, size_t& lineNumber,
+                                   unsigned numThreads, unique_ptr<ThreadPool>& pool,
+                                   vector<vector<Edge>>& runs,
+                                   vector<Automaton::ParseError>* errors) {
+    size_t bytes = (size_t)(end - begin);
+    vector<Chunk> chunks;
+
+    if (numThreads > 1 && bytes >= PARALLEL_MIN_BYTES) {
+        if (!pool) pool = make_unique<ThreadPool>(numThreads);
+
+        chunks = splitLines(begin, end, max(MIN_CHUNK_BYTES, bytes / (4 * (size_t)numThreads)));
+        atomic<size_t> firstStop(chunks.size());
+
+        pool->parallelFor(chunks.size(), 1, [&](size_t first, size_t last, unsigned) {
+            for (size_t i = first; i < last; i++) {
+                if (i > firstStop.load()) continue;
+
+                parseTransitions(chunks[i]);
+                if (!chunks[i].stop) continue;
+
+                size_t seen = firstStop.load();
+                while (i < seen && !firstStop.compare_exchange_weak(seen, i)) {}
+            }
+        });
+
+        chunks.erase(chunks.begin() + min(firstStop.load() + 1, chunks.size()), chunks.end());
+    } else {
+        chunks.emplace_back(begin, end);
+        parseTransitions(chunks[0]);
+    }
+
+    for (Chunk& chunk : chunks) {
+        if (errors) {
+            for (auto& [line, message] : chunk.errors) {
+                errors->push_back({ lineNumber + line + 1, std::move(message) });
             }
         }
+        lineNumber += chunk.lines;
+        runs.push_back(std::move(chunk.edges));
+    }
 
-        // --------------------------------------------------------------
-        // TRANSITIONS:
-        // Format: <from> <symbol> <to>
-        // --------------------------------------------------------------
-        else if (label == "TRANSITIONS:") {
-            int from, to;
-            char c;
+    return chunks.back().stop ? chunks.back().stop : end;
+}
+
+/**
+ * @brief Sorts and dedupes v, then builds a set from it in linear time.
+ */
+template <class T>
+set<T> toSet(vector<T>& v) {
+    sort(v.begin(), v.end());
+    v.erase(unique(v.begin(), v.end()), v.end());
+    return set<T>(v.begin(), v.end());
+}
+
+} // namespace
+
+Automaton Automaton::readAutomaton(const string& filename) {
+    FileText file(filename);
+    if (!file.exists()) return Automaton();
+
+    vector<ParseError> errors;
+    Automaton A = parseAutomaton(file.text(), &errors);
+    reportErrors(filename, errors);
+    return A;
+}
+
+/**
+ * @brief Parses the automaton format of readAutomaton(filename) from any
+ *        input stream.
+ */
+Automaton Automaton::readAutomaton(istream& fin) {
+    string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+
+    vector<ParseError> errors;
+    Automaton A = parseAutomaton(text, &errors);
+    reportErrors("<stream>", errors);
+    return A;
+}
+
+/**
+ * @brief Parser behind both readAutomaton() overloads.
+ *
+ * @details
+ * One pass over the buffer, with no allocation per line or per token:
+ * states, symbols and transitions are appended to flat vectors, which are
+ * sorted and deduplicated in bulk at the end.  The sets and the transition
+ * map are then built from sorted input, i.e. by appending at the end of
+ * each tree instead of searching it.
+ *
+ * TRANSITIONS sections, the bulk of large files, are parsed by
+ * parseTransitionSection(): in parallel chunks when they are large, each
+ * chunk yielding a sorted run, and the runs are merged pairwise on the
+ * same pool.
+ *
+ * Reported (and skipped): text outside any section, tokens that are not
+ * state ids, and transition lines that are not exactly
+ * "<from> <symbol> <to>" with a one-character symbol.
+ */
+Automaton Automaton::parseAutomaton(string_view text, vector<ParseError>* errors,
+                                    unsigned numThreads) {
+    if (numThreads == 0) numThreads = thread::hardware_concurrency();
+
+    vector<int> states, initials, finals;
+    vector<char> alphabet;
+    vector<vector<Edge>> runs;
+    unique_ptr<ThreadPool> pool;    // created by the first large section
+
+    size_t lineNumber = 0;
+    auto report = [&](string message) {
+        if (errors) errors->push_back({ lineNumber, std::move(message) });
+    };
+
+    Section section = Section::None;
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    // ---------------------------------------------------------------------
+    // Scan line by line; section labels decide how lines are interpreted.
+    // ---------------------------------------------------------------------
+    while (p < end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* lineEnd = newline ? newline : end;
+        lineNumber++;
 
-            while (getline(fin, line) && !line.empty()) {
-                stringstream ss2(line);
-                ss2 >> from >> c >> to;
+        Tokens tokens(p, lineEnd);
+        p = newline ? newline + 1 : end;
 
-                // Insert into transition map
-                A.transitions[{from, c}].insert(to);
+        string_view first = tokens.next();
+        if (first.empty()) {
+            section = Section::None;    // blank line ends the section
+            continue;
+        }
+
+        Section label = sectionOf(first);
+        if (label != Section::None) {
+            section = label;
+            if (!tokens.next().empty()) report("unexpected text after " + string(first));
+
+            if (label == Section::Transitions) {
+                p = parseTransitionSection(p, end, lineNumber, numThreads, pool, runs, errors);
             }
+            continue;
         }
 
-        // --------------------------------------------------------------
-        // INITIAL_STATES:
-        // --------------------------------------------------------------
-        else if (label == "INITIAL_STATES:") {
-            int s;
-            while (getline(fin, line) && !line.empty()) {
-                stringstream ss2(line);
-                while (ss2 >> s) {
-                    A.initialStates.insert(s);
+        switch (section) {
+
+        case Section::None:
+            report("'" + string(first) + "' is outside any section");
+            break;
+
+        case Section::States:
+        case Section::Initial:
+        case Section::Final: {
+            vector<int>& target = section == Section::States ? states
+                                : section == Section::Initial ? initials : finals;
+            for (string_view token = first; !token.empty(); token = tokens.next()) {
+                int s;
+                if (parseState(token, s)) {
+                    target.push_back(s);
+                } else {
+                    report("'" + string(token) + "' is not a state");
                 }
             }
+            break;
         }
 
-        // --------------------------------------------------------------
-        // FINAL_STATES:
-        // --------------------------------------------------------------
-        else if (label == "FINAL_STATES:") {
-            int s;
-            while (getline(fin, line) && !line.empty()) {
-                stringstream ss2(line);
-                while (ss2 >> s) {
-                    A.finalStates.insert(s);
-                }
+        case Section::Alphabet:
+            for (string_view token = first; !token.empty(); token = tokens.next()) {
+                alphabet.insert(alphabet.end(), token.begin(), token.end());
             }
+            break;
+
+        case Section::Transitions:
+            break;      // consumed by parseTransitionSection()
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Build the sets and the transition map from sorted, deduplicated data.
+    // ---------------------------------------------------------------------
+    Automaton A;
+    A.states = toSet(states);
+    A.alphabet = toSet(alphabet);
+    A.initialStates = toSet(initials);
+    A.finalStates = toSet(finals);
+
+    vector<Edge> edges;
+    if (pool) {
+        edges = mergeRuns(std::move(runs), *pool);
+    } else if (runs.size() == 1) {
+        edges = std::move(runs[0]);
+    } else {
+        for (auto& run : runs) edges.insert(edges.end(), run.begin(), run.end());
+        sort(edges.begin(), edges.end());
+    }
+
+    auto slot = A.transitions.end();
+    for (size_t i = 0; i < edges.size(); i++) {
+        auto [u, c, v] = edges[i];
+        if (i > 0 && edges[i] == edges[i - 1]) continue;
+
+        if (slot == A.transitions.end() || slot->first != make_pair(u, c)) {
+            slot = A.transitions.emplace_hint(A.transitions.end(), make_pair(u, c), set<int>());
         }
+        slot->second.emplace_hint(slot->second.end(), v);
     }
 
-    fin.close();
     return A;
 }
@@ -1,197 +1,477 @@
 #include "../include/RegexAST.h"
-#include <sstream>
+#include "../include/RegexArena.h"
+#include <cstring>
+#include <mutex>
 
 /*
- * Constructor: initialize node with a specific kind.
- * Literal is set to 0 by default; it is only used for LITERAL nodes.
+ * Hash-consing
+ *
+ * All live nodes are kept in one global open-addressing table (linear
+ * probing on the structural hash). The table holds weak references, so
+ * a node dies with its last user; dead entries are dropped when the
+ * table is rebuilt, which happens whenever it would become half full.
+ * A mutex makes the factories safe to call from several threads.
+ */
+struct UniqueTable {
+    struct Slot {
+        uint64_t hash = 0;
+        bool used = false;
+        std::weak_ptr<Regex> node;
+    };
+
+    std::mutex lock;
+    std::vector<Slot> slots = std::vector<Slot>(1024);
+    size_t used = 0;
+
+    /* Rebuilds with the live entries only, at load at most 1/4. */
+    void rebuild() {
+        size_t live = 0;
+        for (auto &s : slots)
+            if (s.used && !s.node.expired()) live++;
+
+        size_t capacity = 1024;
+        while (capacity < 4 * (live + 1)) capacity *= 2;
+
+        std::vector<Slot> fresh(capacity);
+        size_t mask = capacity - 1;
+
+        for (auto &s : slots) {
+            if (!s.used || s.node.expired()) continue;
+
+            size_t i = (size_t)s.hash & mask;
+            while (fresh[i].used) i = (i + 1) & mask;
+            fresh[i] = std::move(s);
+        }
+
+        slots.swap(fresh);
+        used = live;
+    }
+};
+
+/* Never destroyed, so nodes in static storage may outlive main(). */
+static UniqueTable &uniqueTable() {
+    static UniqueTable *table = new UniqueTable;
+    return *table;
+}
+
+/* splitmix64 finalizer */
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t combine(uint64_t h, uint64_t v) {
+    return mix64(h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)));
+}
+
+/*
+ * Constructor: caches size and cost from the (already built) children.
+ * Called only from intern().
  */
-Regex::Regex(RKind k) : kind(k), literal(0) {}
+Regex::Regex(Token, RKind k, char lit, std::vector<std::shared_ptr<Regex>> kids,
+             std::shared_ptr<Regex> c, uint64_t h, const RegexArena *arena)
+    : kind(k), literal(lit), children(std::move(kids)), child(std::move(c)),
+      hashValue(h),
+      sizeValue([&] {
+          size_t n = 1;
+          for (auto &x : children) n += x ? x->size() : 0;
+          if (child) n += child->size();
+          return n;
+      }()),
+      costValue([&] {
+          int sum = 0;
+          for (auto &x : children) sum += x ? x->cost() : 0;
+
+          switch (k) {
+              case RKind::STAR:   return 1 + (child ? child->cost() : 0);
+              case RKind::CONCAT: return sum + (int)children.size() - 1;
+              case RKind::UNION:  return sum + 3;   // UNION weighted slightly higher
+              default:            return 1;
+          }
+      }()),
+      textValue([&] {
+          size_t n = 0;
+          for (auto &x : children) {
+              if (!x) continue;
+              n += x->textLength();
+              if (k == RKind::CONCAT && x->kind == RKind::UNION) n += 2;   // "(...)"
+          }
+
+          switch (k) {
+              case RKind::EMPTYSET: return (size_t)0;
+              case RKind::EPS:
+              case RKind::LITERAL:  return (size_t)1;
+              case RKind::UNION:    return n + (children.empty() ? 0 : children.size() - 1);
+              case RKind::CONCAT:   return n;
+              case RKind::STAR: {
+                  if (!child) return (size_t)3;
+                  bool bare = child->kind == RKind::LITERAL || child->kind == RKind::EPS;
+                  return child->textLength() + (bare ? 1 : 3);
+              }
+          }
+          return n;
+      }()),
+      owner(arena) {}
+
+/*
+ * deferredDelete(p)
+ *
+ * Deleter of globally tabled nodes. Deleting a node releases its
+ * children, which may delete them in turn; instead of recursing (and
+ * overflowing the stack on deep trees) nested deletions are queued and
+ * run by the outermost call.
+ */
+static void deferredDelete(Regex *p) {
+    static thread_local std::vector<Regex *> pending;
+    static thread_local bool draining = false;
+
+    pending.push_back(p);
+    if (draining) return;
+
+    draining = true;
+    while (!pending.empty()) {
+        Regex *q = pending.back();
+        pending.pop_back();
+        delete q;
+    }
+    draining = false;
+}
+
+/*
+ * sameNode(node, k, lit, kids, c)
+ *
+ * Structural test for interning. Children are already unique, so only
+ * their pointers are compared.
+ */
+static bool sameNode(const Regex &node, RKind k, char lit,
+                     const std::vector<std::shared_ptr<Regex>> &kids,
+                     const std::shared_ptr<Regex> &c) {
+    return node.kind == k && node.literal == lit &&
+           node.child == c && node.children == kids;
+}
+
+/*
+ * intern(k, lit, kids, c)
+ *
+ * Returns the live node with this structure, creating it if needed.
+ *
+ * With an arena active, the arena chain is searched first. The global
+ * table can only hold the node if none of its children is arena-owned.
+ * A missing node is then created in the innermost arena.
+ */
+std::shared_ptr<Regex> Regex::intern(RKind k, char lit,
+                                     std::vector<std::shared_ptr<Regex>> kids,
+                                     std::shared_ptr<Regex> c) {
+    uint64_t h = combine(mix64((uint64_t)k + 1), (unsigned char)lit);
+    for (auto &x : kids) h = combine(h, x ? x->hash() : 0);
+    if (c) h = combine(h, c->hash());
+
+    RegexArena *arena = RegexArena::innermost;
+
+    if (arena) {
+        for (RegexArena *a = arena; a; a = a->enclosing) {
+            uint32_t id = a->find(h, k, lit, kids, c);
+            if (id != RegexArena::NONE) return a->nodes[id];
+        }
+
+        bool global = !(c && c->owner);
+        for (auto &x : kids) global = global && !(x && x->owner);
+
+        if (global) {
+            UniqueTable &table = uniqueTable();
+            std::lock_guard<std::mutex> guard(table.lock);
+
+            size_t mask = table.slots.size() - 1;
+            for (size_t i = (size_t)h & mask; table.slots[i].used; i = (i + 1) & mask) {
+                if (table.slots[i].hash != h) continue;
+
+                std::shared_ptr<Regex> node = table.slots[i].node.lock();
+                if (node && sameNode(*node, k, lit, kids, c)) return node;
+            }
+        }
+
+        auto node = std::allocate_shared<Regex>(
+            std::pmr::polymorphic_allocator<Regex>(&arena->buffer),
+            Token{}, k, lit, std::move(kids), std::move(c), h, arena);
+
+        arena->add(node);
+        return node;
+    }
+
+    UniqueTable &table = uniqueTable();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    size_t mask = table.slots.size() - 1;
+    size_t i = (size_t)h & mask;
+
+    for (; table.slots[i].used; i = (i + 1) & mask) {
+        if (table.slots[i].hash != h) continue;
+
+        std::shared_ptr<Regex> node = table.slots[i].node.lock();
+        if (node && sameNode(*node, k, lit, kids, c)) return node;
+    }
+
+    std::shared_ptr<Regex> node(new Regex(Token{}, k, lit, std::move(kids), std::move(c), h, nullptr),
+                                deferredDelete);
+
+    if (2 * (table.used + 1) > table.slots.size()) {
+        table.rebuild();
+        mask = table.slots.size() - 1;
+        for (i = (size_t)h & mask; table.slots[i].used; i = (i + 1) & mask) {}
+    }
+
+    table.slots[i].hash = h;
+    table.slots[i].used = true;
+    table.slots[i].node = node;
+    table.used++;
+    return node;
+}
 
 /*
  * Factory: create EMPTYSET node (represents φ).
  */
 std::shared_ptr<Regex> Regex::makeEmpty() {
-    return std::make_shared<Regex>(RKind::EMPTYSET);
+    return intern(RKind::EMPTYSET, 0, {}, nullptr);
 }
 
 /*
  * Factory: create EPS node (represents epsilon, '#').
  */
 std::shared_ptr<Regex> Regex::makeEps() {
-    return std::make_shared<Regex>(RKind::EPS);
+    return intern(RKind::EPS, 0, {}, nullptr);
 }
 
 /*
  * Factory: create literal node storing a single character.
  */
 std::shared_ptr<Regex> Regex::makeLit(char c) {
-    auto r = std::make_shared<Regex>(RKind::LITERAL);
-    r->literal = c;
-    return r;
+    return intern(RKind::LITERAL, c, {}, nullptr);
 }
 
 /*
  * Factory: create UNION node with a vector of child expressions.
  */
 std::shared_ptr<Regex> Regex::makeUnion(std::vector<std::shared_ptr<Regex>> v) {
-    auto r = std::make_shared<Regex>(RKind::UNION);
-    r->children = std::move(v);
-    return r;
+    return intern(RKind::UNION, 0, std::move(v), nullptr);
 }
 
 /*
  * Factory: create CONCAT node with a vector of child expressions.
  */
 std::shared_ptr<Regex> Regex::makeConcat(std::vector<std::shared_ptr<Regex>> v) {
-    auto r = std::make_shared<Regex>(RKind::CONCAT);
-    r->children = std::move(v);
-    return r;
+    return intern(RKind::CONCAT, 0, std::move(v), nullptr);
 }
 
 /*
  * Factory: create STAR node with a single child expression.
  */
 std::shared_ptr<Regex> Regex::makeStar(std::shared_ptr<Regex> c) {
-    auto r = std::make_shared<Regex>(RKind::STAR);
-    r->child = c;
-    return r;
+    return intern(RKind::STAR, 0, {}, std::move(c));
 }
 
 /*
- * Helper: print child with parentheses when needed.
- * (Used internally for generating string forms.)
+ * TextPiece
+ *
+ * One step of a lazily expanded toString() or key(): either a node
+ * still to be expanded, or a run of bytes of the output. Both are
+ * produced with an explicit stack, so depth is not limited by the
+ * call stack.
  */
-static void parenIfNeeded(std::ostringstream &os, const std::shared_ptr<Regex>& r) {
-    if (r->kind == RKind::UNION || r->kind == RKind::CONCAT) {
-        os << "(" << r->toString() << ")";
-    } else {
-        os << r->toString();
-    }
-}
+struct TextPiece {
+    const Regex *node;
+    const char *bytes;
+    size_t len;
+};
 
 /*
- * toString()
+ * expandKey(stack)
  *
- * Converts an AST node into its string representation.
- * This matches the project’s regex formatting conventions.
+ * Replaces the node on top of the stack by the pieces of its key(),
+ * pushed in reverse so the first byte ends up on top.
  */
-std::string Regex::toString() const {
-    std::ostringstream os;
+static void expandKey(std::vector<TextPiece> &stack) {
+    static const char *const prefix[] = { "0:", "1:", "2:", "3:", "4:", "5:" };
 
-    switch (kind) {
+    const Regex *n = stack.back().node;
+    stack.pop_back();
 
-        case RKind::EMPTYSET:
-            return "";     // empty language is printed as empty string
+    switch (n->kind) {
+        case RKind::LITERAL:
+            stack.push_back({ nullptr, &n->literal, 1 });
+            break;
 
         case RKind::EPS:
-            return "#";    // epsilon is printed as "#"
-
-        case RKind::LITERAL: {
-            os << literal;
-            return os.str();
-        }
+            stack.push_back({ nullptr, "#", 1 });
+            break;
 
-        case RKind::UNION: {
-            for (size_t i = 0; i < children.size(); ++i) {
-                if (i) os << "|";
-                os << children[i]->toString();
-            }
-            return os.str();
-        }
+        case RKind::EMPTYSET:
+            stack.push_back({ nullptr, "φ", sizeof("φ") - 1 });
+            break;
 
-        case RKind::CONCAT: {
-            for (auto &c : children) {
-                if (c->kind == RKind::UNION)
-                    os << "(" << c->toString() << ")";
-                else
-                    os << c->toString();
+        case RKind::UNION:
+        case RKind::CONCAT:
+            for (size_t i = n->children.size(); i-- > 0; ) {
+                stack.push_back({ nullptr, ",", 1 });
+                stack.push_back({ n->children[i].get(), nullptr, 0 });
             }
-            return os.str();
-        }
+            break;
 
-        case RKind::STAR: {
-            auto &c = child;
-            if (c->kind == RKind::LITERAL || c->kind == RKind::EPS) {
-                os << c->toString() << "*";
-            } else {
-                os << "(" << c->toString() << ")*";
-            }
-            return os.str();
-        }
+        case RKind::STAR:
+            stack.push_back({ n->child.get(), nullptr, 0 });
+            break;
     }
 
-    return "";
+    stack.push_back({ nullptr, prefix[static_cast<int>(n->kind)], 2 });
 }
 
 /*
- * key()
+ * expandText(stack)
  *
- * Produces a canonical structural string for this node.
- * Used for:
- *   - sorting UNION/CONCAT children
- *   - testing structural equality between subtrees
+ * Like expandKey(), for toString():
+ *   UNION  : children separated by "|"
+ *   CONCAT : children, UNION children in parentheses
+ *   STAR   : "x*" for a literal or #, "(...)*" otherwise
+ *   EMPTYSET prints as "" (empty language)
  */
-std::string Regex::key() const {
-    std::ostringstream os;
-    os << static_cast<int>(kind) << ":";
+static void expandText(std::vector<TextPiece> &stack) {
+    const Regex *n = stack.back().node;
+    stack.pop_back();
 
-    switch (kind) {
-        case RKind::LITERAL:
-            os << literal;
+    switch (n->kind) {
+        case RKind::EMPTYSET:
             break;
 
         case RKind::EPS:
-            os << "#";
+            stack.push_back({ nullptr, "#", 1 });
             break;
 
-        case RKind::EMPTYSET:
-            os << "φ";
+        case RKind::LITERAL:
+            stack.push_back({ nullptr, &n->literal, 1 });
             break;
 
         case RKind::UNION:
+            for (size_t i = n->children.size(); i-- > 0; ) {
+                if (n->children[i]) stack.push_back({ n->children[i].get(), nullptr, 0 });
+                if (i > 0) stack.push_back({ nullptr, "|", 1 });
+            }
+            break;
+
         case RKind::CONCAT:
-            for (auto &c : children)
-                os << c->key() << ",";
+            for (size_t i = n->children.size(); i-- > 0; ) {
+                const Regex *c = n->children[i].get();
+                if (!c) continue;
+
+                if (c->kind == RKind::UNION) {
+                    stack.push_back({ nullptr, ")", 1 });
+                    stack.push_back({ c, nullptr, 0 });
+                    stack.push_back({ nullptr, "(", 1 });
+                } else {
+                    stack.push_back({ c, nullptr, 0 });
+                }
+            }
             break;
 
-        case RKind::STAR:
-            os << child->key();
+        case RKind::STAR: {
+            const Regex *c = n->child.get();
+            if (c && (c->kind == RKind::LITERAL || c->kind == RKind::EPS)) {
+                stack.push_back({ nullptr, "*", 1 });
+                stack.push_back({ c, nullptr, 0 });
+            } else {
+                stack.push_back({ nullptr, ")*", 2 });
+                if (c) stack.push_back({ c, nullptr, 0 });
+                stack.push_back({ nullptr, "(", 1 });
+            }
             break;
+        }
     }
+}
 
-    return os.str();
+/*
+ * drain(stack, expand)
+ *
+ * Runs an expansion to the end, appending every byte run to out.
+ */
+static void drain(std::vector<TextPiece> &stack, void (*expand)(std::vector<TextPiece> &),
+                  std::string &out) {
+    while (!stack.empty()) {
+        if (stack.back().node) {
+            expand(stack);
+        } else {
+            out.append(stack.back().bytes, stack.back().len);
+            stack.pop_back();
+        }
+    }
 }
 
 /*
- * cost()
+ * toString()
  *
- * Returns a heuristic complexity measure for the subtree.
- * Used inside the normalizer to choose between alternative
- * rewritings (e.g., factored vs. distributed).
+ * Converts an AST node into its string representation.
+ * This matches the project’s regex formatting conventions.
+ */
+std::string Regex::toString() const {
+    std::string out;
+    out.reserve(textLength());
+
+    std::vector<TextPiece> stack{ { this, nullptr, 0 } };
+    drain(stack, expandText, out);
+    return out;
+}
+
+/*
+ * key()
  *
- * Lower cost = preferred expression.
+ * Produces a canonical structural string for this node:
+ *   "<kind>:" followed by the literal, "#", "φ", the child's key,
+ *   or each child's key and ",".
+ * Used for testing structural equality in tools and debugging.
  */
-int Regex::cost() const {
-    switch (kind) {
-        case RKind::EMPTYSET: return 1;
-        case RKind::EPS:      return 1;
-        case RKind::LITERAL:  return 1;
+std::string Regex::key() const {
+    std::string out;
+    out.reserve(4 * size());
 
-        case RKind::STAR:
-            return 1 + child->cost();
+    std::vector<TextPiece> stack{ { this, nullptr, 0 } };
+    drain(stack, expandKey, out);
+    return out;
+}
 
-        case RKind::CONCAT: {
-            int s = 0;
-            for (auto &c : children) s += c->cost();
-            return s + (int)children.size() - 1;
-        }
+/*
+ * compareKey(other)
+ *
+ * Walks both keys byte by byte, as std::string comparison would. When
+ * both sides are about to expand the same node, its key is skipped on
+ * both at once.
+ */
+int Regex::compareKey(const Regex &other) const {
+    if (this == &other) return 0;
 
-        case RKind::UNION: {
-            int s = 0;
-            for (auto &c : children) s += c->cost();
-            return s + 3;   // UNION weighted slightly higher
+    std::vector<TextPiece> a{ { this, nullptr, 0 } };
+    std::vector<TextPiece> b{ { &other, nullptr, 0 } };
+
+    while (true) {
+        if (!a.empty() && !b.empty() && a.back().node && a.back().node == b.back().node) {
+            a.pop_back();
+            b.pop_back();
+            continue;
         }
-    }
+        if (!a.empty() && a.back().node) { expandKey(a); continue; }
+        if (!b.empty() && b.back().node) { expandKey(b); continue; }
 
-    return 1;
+        if (a.empty() || b.empty())
+            return (int)!a.empty() - (int)!b.empty();
+
+        TextPiece &x = a.back();
+        TextPiece &y = b.back();
+        size_t n = std::min(x.len, y.len);
+
+        int c = std::memcmp(x.bytes, y.bytes, n);
+        if (c != 0) return c < 0 ? -1 : 1;
+
+        x.bytes += n; x.len -= n;
+        y.bytes += n; y.len -= n;
+        if (x.len == 0) a.pop_back();
+        if (y.len == 0) b.pop_back();
+    }
 }
@@ -0,0 +1,71 @@
+#include "../include/RegexArena.h"
+
+thread_local RegexArena *RegexArena::innermost = nullptr;
+
+/*
+ * RegexArena(initialBytes)
+ *
+ * Opens the session: from now on this thread's factories allocate here.
+ */
+RegexArena::RegexArena(size_t initialBytes)
+    : buffer(initialBytes),
+      nodes(&buffer),
+      hashes(&buffer),
+      slots(1024, NONE, &buffer),
+      enclosing(innermost) {
+    innermost = this;
+}
+
+/*
+ * ~RegexArena()
+ *
+ * Drops the nodes newest first. A node's children are older, so each
+ * release only destroys that one node (no recursive cascade through deep
+ * trees); the buffer is then released as a whole.
+ */
+RegexArena::~RegexArena() {
+    innermost = enclosing;
+
+    while (!nodes.empty())
+        nodes.pop_back();
+}
+
+uint32_t RegexArena::find(uint64_t h, RKind k, char lit,
+                          const std::vector<std::shared_ptr<Regex>> &kids,
+                          const std::shared_ptr<Regex> &c) const {
+    size_t mask = slots.size() - 1;
+
+    for (size_t i = (size_t)h & mask; slots[i] != NONE; i = (i + 1) & mask) {
+        uint32_t id = slots[i];
+        if (hashes[id] != h) continue;
+
+        const Regex &n = *nodes[id];
+        if (n.kind == k && n.literal == lit && n.child == c && n.children == kids)
+            return id;
+    }
+
+    return NONE;
+}
+
+void RegexArena::add(const std::shared_ptr<Regex> &node) {
+    if (2 * (nodes.size() + 1) > slots.size()) {
+        std::pmr::vector<uint32_t> bigger(slots.size() * 2, NONE, &buffer);
+        size_t mask = bigger.size() - 1;
+
+        for (uint32_t id = 0; id < nodes.size(); id++) {
+            size_t i = (size_t)hashes[id] & mask;
+            while (bigger[i] != NONE) i = (i + 1) & mask;
+            bigger[i] = id;
+        }
+
+        slots.swap(bigger);
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = (size_t)node->hash() & mask;
+    while (slots[i] != NONE) i = (i + 1) & mask;
+
+    slots[i] = (uint32_t)nodes.size();
+    nodes.push_back(node);
+    hashes.push_back(node->hash());
+}
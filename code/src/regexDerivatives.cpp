@@ -0,0 +1,314 @@
+#include "../include/RegexDerivatives.h"
+#include "../include/RegexNormalize.h"
+#include "../include/RegexArena.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * collectLiterals(r, out)
+ *
+ * Adds every LITERAL symbol of r to out.
+ */
+static void collectLiterals(const std::shared_ptr<Regex> &r, std::set<char> &out) {
+    if (!r) return;
+
+    switch (r->kind) {
+        case RKind::LITERAL:
+            out.insert(r->literal);
+            return;
+
+        case RKind::UNION:
+        case RKind::CONCAT:
+            for (auto &c : r->children) collectLiterals(c, out);
+            return;
+
+        case RKind::STAR:
+            collectLiterals(r->child, out);
+            return;
+
+        default:
+            return;
+    }
+}
+
+/*
+ * DerivativeBuilder
+ *
+ * Ids for normalised expressions plus the (partial) derivative caches
+ * shared by regexToDerivativeDFA and regexToAntimirov.
+ *
+ * Regex nodes are hash-consed, so two structurally equal expressions are
+ * the same node; intern() only has to number nodes by address.  The
+ * nodes vector keeps every numbered node alive, so an address is never
+ * reused for a different expression.
+ */
+struct DerivativeBuilder {
+    std::vector<std::shared_ptr<Regex>> nodes;      /* id → node */
+    std::vector<char> nullableOf;                   /* id → ε ∈ L(node) */
+    std::unordered_map<const Regex *, int> idOf;    /* node → id */
+    std::map<std::pair<int, char>, int> derivative; /* (id, a) → id of d_a */
+    std::map<std::pair<int, char>, std::vector<int>> partial; /* (id, a) → ids of pd_a */
+
+    int intern(const std::shared_ptr<Regex> &r) {
+        auto known = idOf.find(r.get());
+        if (known != idOf.end()) return known->second;
+
+        bool nullable = false;
+
+        switch (r->kind) {
+            case RKind::EMPTYSET:
+            case RKind::LITERAL:
+                break;
+
+            case RKind::EPS:
+            case RKind::STAR:
+                nullable = true;
+                break;
+
+            case RKind::UNION:
+                for (auto &c : r->children)
+                    nullable = nullable || nullableOf[intern(c)];
+                break;
+
+            case RKind::CONCAT:
+                nullable = true;
+                for (auto &c : r->children)
+                    nullable = nullableOf[intern(c)] && nullable;
+                break;
+        }
+
+        int id = (int)nodes.size();
+        nodes.push_back(r);
+        nullableOf.push_back(nullable ? 1 : 0);
+        idOf[r.get()] = id;
+        return id;
+    }
+
+    /* Normalise, then intern. */
+    int canonical(const std::shared_ptr<Regex> &r) {
+        return intern(normalizeRegexAST(r));
+    }
+
+    /*
+     * derive(id, a)
+     *
+     * Id of the normalised derivative d_a(nodes[id]), memoised.
+     */
+    int derive(int id, char a) {
+        auto memo = derivative.find({id, a});
+        if (memo != derivative.end()) return memo->second;
+
+        std::shared_ptr<Regex> r = nodes[id];
+        std::shared_ptr<Regex> d;
+
+        switch (r->kind) {
+            case RKind::EMPTYSET:
+            case RKind::EPS:
+                d = Regex::makeEmpty();
+                break;
+
+            case RKind::LITERAL:
+                d = (r->literal == a) ? Regex::makeEps() : Regex::makeEmpty();
+                break;
+
+            case RKind::UNION: {
+                std::vector<std::shared_ptr<Regex>> alts;
+                for (auto &c : r->children)
+                    alts.push_back(nodes[derive(intern(c), a)]);
+                d = Regex::makeUnion(alts);
+                break;
+            }
+
+            case RKind::CONCAT: {
+                /* r = head · rest */
+                int head = intern(r->children[0]);
+
+                std::vector<std::shared_ptr<Regex>> restItems(r->children.begin() + 1,
+                                                              r->children.end());
+                int rest = canonical(Regex::makeConcat(restItems));
+
+                auto left = Regex::makeConcat({ nodes[derive(head, a)], nodes[rest] });
+
+                if (nullableOf[head]) {
+                    d = Regex::makeUnion({ left, nodes[derive(rest, a)] });
+                } else {
+                    d = left;
+                }
+                break;
+            }
+
+            case RKind::STAR:
+                d = Regex::makeConcat({ nodes[derive(intern(r->child), a)], r });
+                break;
+        }
+
+        int result = canonical(d);
+        derivative[{id, a}] = result;
+        return result;
+    }
+
+    /*
+     * partialDerive(id, a)
+     *
+     * Sorted ids of the Antimirov partial derivatives pd_a(nodes[id]),
+     * memoised.  ∅ terms are dropped, so the set may be empty.  The
+     * cache is a std::map, so returned references stay valid.
+     */
+    const std::vector<int> &partialDerive(int id, char a) {
+        auto memo = partial.find({id, a});
+        if (memo != partial.end()) return memo->second;
+
+        std::shared_ptr<Regex> r = nodes[id];
+        std::vector<int> out;
+
+        switch (r->kind) {
+            case RKind::EMPTYSET:
+            case RKind::EPS:
+                break;
+
+            case RKind::LITERAL:
+                if (r->literal == a) out.push_back(canonical(Regex::makeEps()));
+                break;
+
+            case RKind::UNION:
+                for (auto &c : r->children) {
+                    const std::vector<int> &pc = partialDerive(intern(c), a);
+                    out.insert(out.end(), pc.begin(), pc.end());
+                }
+                break;
+
+            case RKind::CONCAT: {
+                /* r = head · rest */
+                int head = intern(r->children[0]);
+
+                std::vector<std::shared_ptr<Regex>> restItems(r->children.begin() + 1,
+                                                              r->children.end());
+                int rest = canonical(Regex::makeConcat(restItems));
+
+                for (int t : partialDerive(head, a))
+                    out.push_back(canonical(Regex::makeConcat({ nodes[t], nodes[rest] })));
+
+                if (nullableOf[head]) {
+                    const std::vector<int> &pr = partialDerive(rest, a);
+                    out.insert(out.end(), pr.begin(), pr.end());
+                }
+                break;
+            }
+
+            case RKind::STAR: {
+                for (int t : partialDerive(intern(r->child), a))
+                    out.push_back(canonical(Regex::makeConcat({ nodes[t], r })));
+                break;
+            }
+        }
+
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+
+        return partial.emplace(std::make_pair(id, a), std::move(out)).first->second;
+    }
+};
+
+/*
+ * regexToDerivativeDFA(r)
+ *
+ * See RegexDerivatives.h. Breadth-first exploration of the derivatives
+ * of r, symbols taken in alphabet order.
+ */
+Automaton regexToDerivativeDFA(const std::shared_ptr<Regex> &r) {
+    std::set<char> alphabet;
+    collectLiterals(r, alphabet);
+
+    /* Derivative terms are scratch: allocate them in an arena. */
+    RegexArena arena;
+    DerivativeBuilder B;
+    int root = B.canonical(r ? r : Regex::makeEmpty());
+
+    Automaton A;
+    A.setAlphabet(alphabet);
+
+    /* Step 1: Initial state = r itself. */
+    std::unordered_map<int, int> stateOf;
+    std::vector<int> queue;
+
+    stateOf[root] = 0;
+    queue.push_back(root);
+    A.addState(0);
+    A.addInitialState(0);
+
+    /* Step 2: BFS over derivatives. */
+    for (size_t i = 0; i < queue.size(); ++i) {
+        int id = queue[i];
+        int from = (int)i;
+
+        if (B.nullableOf[id]) A.addFinalState(from);
+
+        for (char a : alphabet) {
+            int t = B.derive(id, a);
+
+            auto inserted = stateOf.emplace(t, (int)queue.size());
+            if (inserted.second) {
+                queue.push_back(t);
+                A.addState(inserted.first->second);
+            }
+
+            A.addTransition(from, a, inserted.first->second);
+        }
+    }
+
+    return A;
+}
+
+/*
+ * regexToAntimirov(r)
+ *
+ * See RegexDerivatives.h. Same exploration as regexToDerivativeDFA, but a
+ * state has one a-successor per partial derivative.
+ */
+Automaton regexToAntimirov(const std::shared_ptr<Regex> &r) {
+    std::set<char> alphabet;
+    collectLiterals(r, alphabet);
+
+    /* Derivative terms are scratch: allocate them in an arena. */
+    RegexArena arena;
+    DerivativeBuilder B;
+    int root = B.canonical(r ? r : Regex::makeEmpty());
+
+    Automaton A;
+    A.setAlphabet(alphabet);
+
+    /* Step 1: Initial state = r itself. */
+    std::unordered_map<int, int> stateOf;
+    std::vector<int> queue;
+
+    stateOf[root] = 0;
+    queue.push_back(root);
+    A.addState(0);
+    A.addInitialState(0);
+
+    /* Step 2: BFS over partial derivatives. */
+    for (size_t i = 0; i < queue.size(); ++i) {
+        int id = queue[i];
+        int from = (int)i;
+
+        if (B.nullableOf[id]) A.addFinalState(from);
+
+        for (char a : alphabet) {
+            for (int t : B.partialDerive(id, a)) {
+                auto inserted = stateOf.emplace(t, (int)queue.size());
+                if (inserted.second) {
+                    queue.push_back(t);
+                    A.addState(inserted.first->second);
+                }
+
+                A.addTransition(from, a, inserted.first->second);
+            }
+        }
+    }
+
+    return A;
+}
@@ -0,0 +1,179 @@
+#include "../include/RegexNFA.h"
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Positions
+ *
+ * Sorted, duplicate-free list of literal positions.
+ */
+using Positions = std::vector<int>;
+
+/*
+ * mergeInto(dst, src)
+ *
+ * dst ∪= src for sorted position lists.
+ */
+static void mergeInto(Positions &dst, const Positions &src) {
+    if (src.empty()) return;
+    if (dst.empty()) { dst = src; return; }
+
+    Positions out;
+    out.reserve(dst.size() + src.size());
+    std::set_union(dst.begin(), dst.end(), src.begin(), src.end(),
+                   std::back_inserter(out));
+    dst.swap(out);
+}
+
+/*
+ * GlushkovInfo
+ *
+ * Per-subtree result of the bottom-up pass.
+ */
+struct GlushkovInfo {
+    bool nullable = false;
+    Positions first;
+    Positions last;
+};
+
+/*
+ * GlushkovBuilder
+ *
+ * Walks the AST once, numbering literals and filling the follow
+ * relation as each CONCAT and STAR node is completed.
+ */
+struct GlushkovBuilder {
+    std::vector<char> symbolOf;             /* position → literal (index 0 unused) */
+    std::vector<Positions> follow;          /* position → follow set (unsorted) */
+
+    GlushkovBuilder() : symbolOf(1, 0), follow(1) {}
+
+    void addFollow(const Positions &from, const Positions &to) {
+        if (to.empty()) return;
+        for (int p : from)
+            follow[p].insert(follow[p].end(), to.begin(), to.end());
+    }
+
+    GlushkovInfo visit(const std::shared_ptr<Regex> &r) {
+        GlushkovInfo info;
+        if (!r) return info;
+
+        switch (r->kind) {
+
+            case RKind::EMPTYSET:
+                return info;
+
+            case RKind::EPS:
+                info.nullable = true;
+                return info;
+
+            case RKind::LITERAL: {
+                int p = (int)symbolOf.size();
+                symbolOf.push_back(r->literal);
+                follow.emplace_back();
+                info.first.push_back(p);
+                info.last.push_back(p);
+                return info;
+            }
+
+            case RKind::UNION: {
+                for (auto &c : r->children) {
+                    GlushkovInfo ci = visit(c);
+                    info.nullable = info.nullable || ci.nullable;
+                    mergeInto(info.first, ci.first);
+                    mergeInto(info.last, ci.last);
+                }
+                return info;
+            }
+
+            case RKind::CONCAT: {
+                std::vector<GlushkovInfo> parts;
+                parts.reserve(r->children.size());
+                for (auto &c : r->children)
+                    parts.push_back(visit(c));
+
+                /*
+                 * Scan right to left, keeping
+                 *   reach = first of the suffix after part i
+                 * (extended through nullable parts). last(ci) is
+                 * followed by reach.
+                 */
+                Positions reach;
+                bool suffixNullable = true;
+
+                for (size_t i = parts.size(); i-- > 0; ) {
+                    GlushkovInfo &ci = parts[i];
+
+                    addFollow(ci.last, reach);
+
+                    if (suffixNullable)
+                        mergeInto(info.last, ci.last);
+
+                    if (ci.nullable) {
+                        mergeInto(reach, ci.first);
+                    } else {
+                        reach = ci.first;
+                    }
+
+                    suffixNullable = suffixNullable && ci.nullable;
+                }
+
+                info.nullable = suffixNullable;
+                info.first = reach;
+                return info;
+            }
+
+            case RKind::STAR: {
+                info = visit(r->child);
+                addFollow(info.last, info.first);
+                info.nullable = true;
+                return info;
+            }
+        }
+
+        return info;
+    }
+};
+
+/*
+ * regexToGlushkov(r)
+ *
+ * See RegexNFA.h. States are 0..n; the alphabet is the set of
+ * literals of r.
+ */
+Automaton regexToGlushkov(const std::shared_ptr<Regex> &r) {
+    GlushkovBuilder B;
+    GlushkovInfo root = B.visit(r);
+
+    int n = (int)B.symbolOf.size() - 1;
+
+    Automaton A;
+    std::set<char> alphabet;
+
+    for (int p = 0; p <= n; ++p) A.addState(p);
+    A.addInitialState(0);
+
+    /* Step 1: Initial transitions into first(r). */
+    for (int p : root.first)
+        A.addTransition(0, B.symbolOf[p], p);
+
+    /* Step 2: Follow transitions. */
+    for (int p = 1; p <= n; ++p) {
+        alphabet.insert(B.symbolOf[p]);
+
+        Positions &f = B.follow[p];
+        std::sort(f.begin(), f.end());
+        f.erase(std::unique(f.begin(), f.end()), f.end());
+
+        for (int q : f)
+            A.addTransition(p, B.symbolOf[q], q);
+    }
+
+    /* Step 3: Final states. */
+    for (int p : root.last) A.addFinalState(p);
+    if (root.nullable) A.addFinalState(0);
+
+    A.setAlphabet(alphabet);
+    return A;
+}
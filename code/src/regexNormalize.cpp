@@ -10,34 +10,22 @@
  * Utility used by UNION and CONCAT normalization.
  * Performs:
  *   - removal of null children
- *   - lexicographic ordering using each child's key()
+ *   - lexicographic ordering by each child's key() (compareKey)
  *   - duplicate removal
  *
  * Ensures that UNION and CONCAT expressions have a consistent,
- * canonical ordering of subexpressions.
+ * canonical ordering of subexpressions. Nodes are hash-consed, so
+ * duplicates are equal pointers and end up adjacent after sorting.
  */
 static void canonicalizeChildren(std::vector<std::shared_ptr<Regex>>& v) {
-    std::vector<std::shared_ptr<Regex>> tmp;
-    tmp.reserve(v.size());
-    for (auto &c : v)
-        if (c) tmp.push_back(c);
-    v.swap(tmp);
+    v.erase(std::remove(v.begin(), v.end(), nullptr), v.end());
 
     std::sort(v.begin(), v.end(),
         [](const std::shared_ptr<Regex> &a, const std::shared_ptr<Regex> &b){
-            return a->key() < b->key();
+            return a->compareKey(*b) < 0;
         });
 
-    std::vector<std::shared_ptr<Regex>> out;
-    std::string last = "";
-    for (auto &c : v) {
-        std::string k = c->key();
-        if (k != last) {
-            out.push_back(c);
-            last = k;
-        }
-    }
-    v.swap(out);
+    v.erase(std::unique(v.begin(), v.end()), v.end());
 }
 
 /*
@@ -78,16 +66,36 @@ std::shared_ptr<Regex> normalizeRegexAST(std::shared_ptr<Regex> r) {
             if (inner->kind == RKind::EPS)
                 return Regex::makeEps();
 
+            /* unchanged: reuse the node */
+            if (inner == r->child) return r;
+
             return Regex::makeStar(inner);
         }
 
         case RKind::CONCAT: {
+            /*
+             * items stays empty (no allocation) while every child
+             * normalizes to itself; on the first change it takes
+             * over the children seen so far.
+             */
+            const auto &kids = r->children;
             std::vector<std::shared_ptr<Regex>> items;
-            items.reserve(r->children.size());
+            bool changed = false;
+
+            for (size_t i = 0; i < kids.size(); ++i) {
+                auto &c = kids[i];
+                auto n = c ? normalizeRegexAST(c) : c;
+
+                if (!changed) {
+                    if (n && n == c && n->kind != RKind::EMPTYSET &&
+                        n->kind != RKind::EPS && n->kind != RKind::CONCAT)
+                        continue;
+
+                    changed = true;
+                    items.reserve(kids.size());
+                    items.assign(kids.begin(), kids.begin() + i);
+                }
 
-            for (auto &c : r->children) {
-                if (!c) continue;
-                auto n = normalizeRegexAST(c);
                 if (!n) continue;
 
                 /* φ destroys concatenation */
@@ -108,6 +116,12 @@ std::shared_ptr<Regex> normalizeRegexAST(std::shared_ptr<Regex> r) {
                 }
             }
 
+            if (!changed) {
+                if (kids.empty()) return Regex::makeEps();
+                if (kids.size() == 1) return kids[0];
+                return r;
+            }
+
             if (items.empty()) return Regex::makeEps();
             if (items.size() == 1) return items[0];
 
@@ -115,12 +129,25 @@ std::shared_ptr<Regex> normalizeRegexAST(std::shared_ptr<Regex> r) {
         }
 
         case RKind::UNION: {
+            /* Same lazy copy as CONCAT. */
+            const auto &kids = r->children;
             std::vector<std::shared_ptr<Regex>> items;
-            items.reserve(r->children.size());
+            bool changed = false;
+
+            for (size_t i = 0; i < kids.size(); ++i) {
+                auto &c = kids[i];
+                auto n = c ? normalizeRegexAST(c) : c;
+
+                if (!changed) {
+                    if (n && n == c && n->kind != RKind::EMPTYSET &&
+                        n->kind != RKind::UNION)
+                        continue;
+
+                    changed = true;
+                    items.reserve(kids.size());
+                    items.assign(kids.begin(), kids.begin() + i);
+                }
 
-            for (auto &c : r->children) {
-                if (!c) continue;
-                auto n = normalizeRegexAST(c);
                 if (!n) continue;
 
                 /* remove φ inside union */
@@ -137,6 +164,21 @@ std::shared_ptr<Regex> normalizeRegexAST(std::shared_ptr<Regex> r) {
                 }
             }
 
+            /* unchanged and already in canonical order: reuse the node */
+            if (!changed) {
+                bool ordered = true;
+                for (size_t i = 1; i < kids.size() && ordered; ++i)
+                    ordered = kids[i - 1]->compareKey(*kids[i]) < 0;
+
+                if (ordered) {
+                    if (kids.empty()) return Regex::makeEmpty();
+                    if (kids.size() == 1) return kids[0];
+                    return r;
+                }
+
+                items = kids;
+            }
+
             if (items.empty()) return Regex::makeEmpty();
             canonicalizeChildren(items);
             if (items.size() == 1) return items[0];
@@ -174,7 +216,7 @@ std::shared_ptr<Regex> boundedDistribute(std::shared_ptr<Regex> r) {
     }
 
     if (r->kind == RKind::CONCAT) {
-        auto childrenCopy = r->children;
+        const auto &childrenCopy = r->children;
 
         for (size_t i = 0; i < childrenCopy.size(); ++i) {
             auto child = childrenCopy[i];
@@ -245,7 +287,7 @@ std::shared_ptr<Regex> prettifyRegexAST(std::shared_ptr<Regex> r) {
     if (!d) return n;
 
     /* If equivalent structurally, keep normalized form */
-    if (d->key() == n->key()) return n;
+    if (d == n) return n;
 
     /* Choose smaller expression */
     if (d->cost() < n->cost()) return d;
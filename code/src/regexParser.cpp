@@ -1,174 +1,182 @@
 #include "../include/RegexParser.h"
-#include <stack>
 #include <cctype>
+#include <iterator>
+#include <list>
+#include <vector>
 
 /*
- * prec(op)
+ * Operand
  *
- * Precedence table for regex operators:
- *   '*'  : highest
- *   '.'  : concatenation
- *   '|'  : union
+ * An operand of the parser that may not be a Regex node yet:
+ *   - no items   : nothing (an empty sequence or group such as "()")
+ *   - one item   : that node
+ *   - more items : the operands of a CONCAT or UNION (kind) still to be
+ *                  built
+ *
+ * Closed groups stay unbuilt so that an enclosing sequence (or union)
+ * of the same kind can take over their operands by splicing the list,
+ * in O(1), instead of copying the children of a finished node. A node
+ * is built only when the operand is starred, used inside an operator of
+ * the other kind, or is the final result, so every operand is copied
+ * into a node once.
  */
-static int prec(char op) {
-    if (op == '*') return 3;
-    if (op == '.') return 2;
-    if (op == '|') return 1;
-    return 0;
+struct Operand {
+    RKind kind = RKind::CONCAT;
+    std::list<std::shared_ptr<Regex>> items;
+
+    bool empty() const { return items.empty(); }
+    bool pending(RKind k) const { return items.size() > 1 && kind == k; }
+};
+
+static Operand single(std::shared_ptr<Regex> r) {
+    Operand o;
+    o.items.push_back(std::move(r));
+    return o;
 }
 
 /*
- * applyOp(vals, op)
+ * build(o)
  *
- * Applies an operator to the top elements of the value stack.
- * Uses Regex factory functions and flattens UNION and CONCAT nodes
- * to keep the AST compact.
+ * The Regex node of a non-empty operand.
  */
-static void applyOp(std::stack<std::shared_ptr<Regex>> &vals, char op) {
-    if (op == '*') {
-        auto v = vals.top(); vals.pop();
-        vals.push(Regex::makeStar(v));
-    }
-    else if (op == '.') {
-        auto b = vals.top(); vals.pop();
-        auto a = vals.top(); vals.pop();
+static std::shared_ptr<Regex> build(Operand &o) {
+    if (o.items.size() == 1) return o.items.front();
 
-        std::vector<std::shared_ptr<Regex>> items;
+    std::vector<std::shared_ptr<Regex>> v(std::make_move_iterator(o.items.begin()),
+                                          std::make_move_iterator(o.items.end()));
+    return o.kind == RKind::CONCAT ? Regex::makeConcat(std::move(v))
+                                   : Regex::makeUnion(std::move(v));
+}
 
-        /* flatten concatenation on left */
-        if (a->kind == RKind::CONCAT)
-            items.insert(items.end(), a->children.begin(), a->children.end());
-        else
-            items.push_back(a);
+/*
+ * Group
+ *
+ * Parser state for one level of parentheses (the outermost level
+ * included):
+ *   alts : operands of '|' finished so far
+ *   seq  : factors of the alternative being read
+ */
+struct Group {
+    std::list<std::shared_ptr<Regex>> alts;
+    bool hasAlts = false;
+    std::vector<Operand> seq;
+};
 
-        /* flatten concatenation on right */
-        if (b->kind == RKind::CONCAT)
-            items.insert(items.end(), b->children.begin(), b->children.end());
-        else
-            items.push_back(b);
+/*
+ * finishSequence(g)
+ *
+ * Turns the factors read so far into one alternative: nothing for an
+ * empty sequence, the factor itself for one, an unbuilt CONCAT
+ * otherwise, with the operands of unbuilt CONCAT factors spliced in so
+ * that (ab)c and a(bc) both give CONCAT[a,b,c].
+ */
+static Operand finishSequence(Group &g) {
+    Operand r;
 
-        vals.push(Regex::makeConcat(items));
+    if (g.seq.size() == 1) {
+        r = std::move(g.seq[0]);
     }
-    else if (op == '|') {
-        auto b = vals.top(); vals.pop();
-        auto a = vals.top(); vals.pop();
-
-        std::vector<std::shared_ptr<Regex>> items;
-
-        /* flatten UNION on left */
-        if (a->kind == RKind::UNION)
-            items.insert(items.end(), a->children.begin(), a->children.end());
-        else
-            items.push_back(a);
-
-        /* flatten UNION on right */
-        if (b->kind == RKind::UNION)
-            items.insert(items.end(), b->children.begin(), b->children.end());
-        else
-            items.push_back(b);
-
-        vals.push(Regex::makeUnion(items));
+    else if (g.seq.size() > 1) {
+        r.kind = RKind::CONCAT;
+        for (auto &f : g.seq) {
+            if (f.pending(RKind::CONCAT)) r.items.splice(r.items.end(), f.items);
+            else r.items.push_back(build(f));
+        }
     }
+
+    g.seq.clear();
+    return r;
 }
 
 /*
- * insertConcat(in)
+ * addAlternative(g, a)
  *
- * Inserts explicit '.' operators to represent concatenation.
- * Concatenation is implied in standard regex syntax but required
- * here for parsing with precedence.
- *
- * Example:
- *   a(b|c)*d → a.(b|c)*.d
+ * Appends alternative a to g.alts, splicing in the operands of an
+ * unbuilt UNION. An empty alternative next to a '|' (as in "a|")
+ * stands for #.
  */
-std::string insertConcat(const std::string &in) {
-    std::string out;
-
-    for (size_t i = 0; i < in.size(); ++i) {
-        char c1 = in[i];
-        out.push_back(c1);
-
-        if (i + 1 < in.size()) {
-            char c2 = in[i+1];
+static void addAlternative(Group &g, Operand a) {
+    if (a.empty()) g.alts.push_back(Regex::makeEps());
+    else if (a.pending(RKind::UNION)) g.alts.splice(g.alts.end(), a.items);
+    else g.alts.push_back(build(a));
+    g.hasAlts = true;
+}
 
-            bool left =
-                (isalnum(c1) || c1 == '#' || c1 == ')' || c1 == '*');
+/*
+ * finishGroup(g)
+ *
+ * Closes a group: its single alternative, an unbuilt UNION of several,
+ * or nothing for an empty group such as "()".
+ */
+static Operand finishGroup(Group &g) {
+    Operand last = finishSequence(g);
 
-            bool right =
-                (isalnum(c2) || c2 == '#' || c2 == '(');
+    if (!g.hasAlts) return last;
+    addAlternative(g, std::move(last));
 
-            if (left && right)
-                out.push_back('.');
-        }
-    }
-    return out;
+    Operand r;
+    r.kind = RKind::UNION;
+    r.items = std::move(g.alts);
+    return r;
 }
 
 /*
- * parseRegexToAST(s_in)
+ * parseRegexToAST(s)
  *
- * Full regex parser using a shunting-yard-style algorithm.
+ * Single left-to-right pass with an explicit stack of open groups,
+ * so input size and nesting depth are limited only by memory:
  *
- * Steps:
- *   1. Insert explicit concatenation operators.
- *   2. Read characters of the input:
- *        - literals and '#' pushed to value stack
- *        - '(' pushed to operator stack
- *        - ')' causes operator application until '('
- *        - '*', '|', '.' checked against precedence table
- *   3. After scanning, apply remaining operators
- *   4. Resulting stack top is the AST root
+ *   - literals and '#' are appended to the current sequence
+ *   - '*' wraps the last factor of the current sequence
+ *   - '|' closes the current sequence as one alternative
+ *   - '(' opens a group, ')' closes it and appends it as a factor
+ *   - '.' (explicit concatenation) and other characters are skipped
+ *
+ * Precedence is therefore '*' > concatenation > '|'. At the end any
+ * unclosed groups are closed. Operands are spliced between levels and
+ * each node is built once (see Operand), so parsing is linear in the
+ * input whatever the nesting.
  */
-std::shared_ptr<Regex> parseRegexToAST(const std::string &s_in) {
-    std::string s = insertConcat(s_in);
-
-    std::stack<char> ops;
-    std::stack<std::shared_ptr<Regex>> vals;
+std::shared_ptr<Regex> parseRegexToAST(const std::string &s) {
+    std::vector<Group> groups(1);
 
-    for (size_t i = 0; i < s.size(); ++i) {
-        char c = s[i];
+    for (char c : s) {
+        Group &g = groups.back();
 
-        if (isalnum(c) || c == '#') {
-            if (c == '#')
-                vals.push(Regex::makeEps());
-            else
-                vals.push(Regex::makeLit(c));
+        if (isalnum((unsigned char)c)) {
+            g.seq.push_back(single(Regex::makeLit(c)));
+        }
+        else if (c == '#') {
+            g.seq.push_back(single(Regex::makeEps()));
+        }
+        else if (c == '*') {
+            if (!g.seq.empty())
+                g.seq.back() = single(Regex::makeStar(build(g.seq.back())));
+        }
+        else if (c == '|') {
+            addAlternative(g, finishSequence(g));
         }
-
         else if (c == '(') {
-            ops.push(c);
+            groups.emplace_back();
         }
-
         else if (c == ')') {
-            while (!ops.empty() && ops.top() != '(') {
-                char op = ops.top(); ops.pop();
-                applyOp(vals, op);
-            }
-            if (!ops.empty() && ops.top() == '(')
-                ops.pop();
-        }
+            if (groups.size() == 1) continue;   /* unmatched ')' */
 
-        else if (c == '*' || c == '|' || c == '.') {
-            while (!ops.empty() && ops.top() != '(' &&
-                   prec(ops.top()) >= prec(c)) {
-                char op = ops.top(); ops.pop();
-                applyOp(vals, op);
-            }
-            ops.push(c);
+            Operand inner = finishGroup(g);
+            groups.pop_back();
+            if (!inner.empty()) groups.back().seq.push_back(std::move(inner));
         }
-
         else {
-            /* ignore unknown/non-regex characters */
+            /* ignore '.' and unknown/non-regex characters */
         }
     }
 
-    while (!ops.empty()) {
-        char op = ops.top(); ops.pop();
-        applyOp(vals, op);
+    while (groups.size() > 1) {
+        Operand inner = finishGroup(groups.back());
+        groups.pop_back();
+        if (!inner.empty()) groups.back().seq.push_back(std::move(inner));
     }
 
-    if (vals.empty())
-        return Regex::makeEmpty();
-
-    return vals.top();
+    Operand root = finishGroup(groups.back());
+    return root.empty() ? Regex::makeEmpty() : build(root);
 }
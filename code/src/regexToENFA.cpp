@@ -1,11 +1,13 @@
 #include "../include/Automaton.h"
 #include "../include/Dot.h"
 #include "../include/RegexENFA.h"
+#include "../include/RegexAST.h"
 
 #include <iostream>
 #include <fstream>
 #include <stack>
 #include <string>
+#include <vector>
 #include <cctype>
 
 using namespace std;
@@ -264,13 +266,131 @@ Automaton regexToENFA(const string& inputBaseName) {
     A.addFinalState(result.end);
 
     /*
-     * Write automaton + generate DOT + PNG
+     * Write automaton + generate DOT + PNG (as the artifact policy allows)
      */
-    A.writeAutomaton(outputPath);
-
     Dot dotGen;
-    dotGen.generateDot(outputPath, dotPath, "ENFA");
-    dotGen.generateImage(dotPath, "enfa_", inputBaseName);
+    dotGen.writeArtifacts(A, outputPath, dotPath, "ENFA", "enfa_", inputBaseName);
+
+    return A;
+}
+
+/*
+ * regexToENFA(r)
+ *
+ * Thompson's construction straight from a Regex AST, in memory: no
+ * files, no images.  The same fragments as the file-based version, with
+ * the n-ary nodes of the AST handled in one step:
+ *
+ *   - LITERAL a / EPS  : s --a--> t  /  s --#--> t
+ *   - EMPTYSET         : s  t, no transition
+ *   - CONCAT f1 .. fn  : fi.end --ε--> f(i+1).start
+ *   - UNION f1 | .. fn : start --ε--> fi.start, fi.end --ε--> end
+ *   - STAR f*          : as in the file-based version
+ *
+ * The AST is walked with an explicit stack (post-order), so deep regexes
+ * cannot overflow the call stack, and states are numbered locally, so
+ * concurrent calls are safe.  Shared subexpressions are expanded once per
+ * occurrence, as Thompson's construction requires.
+ */
+Automaton regexToENFA(const Regex& r) {
+    Automaton A;
+    int counter = 0;
+
+    auto newState = [&]() {
+        int s = counter++;
+        A.addState(s);
+        return s;
+    };
+
+    struct Frame {
+        const Regex* node;
+        size_t next;    // next child to visit
+        size_t base;    // first fragment of this node's children
+    };
+
+    vector<Frame> frames;
+    vector<ENFAFragment> frags;
+    frames.push_back({ &r, 0, 0 });
+
+    while (!frames.empty()) {
+        Frame& f = frames.back();
+        const Regex& n = *f.node;
+
+        /*
+         * Descend into the next child, if any
+         */
+        if (n.kind == RKind::UNION || n.kind == RKind::CONCAT) {
+            if (f.next < n.children.size()) {
+                const Regex* c = n.children[f.next++].get();
+                frames.push_back({ c, 0, frags.size() });
+                continue;
+            }
+        } else if (n.kind == RKind::STAR && f.next == 0) {
+            f.next = 1;
+            frames.push_back({ n.child.get(), 0, frags.size() });
+            continue;
+        }
+
+        /*
+         * All children done: build this node's fragment
+         */
+        ENFAFragment out;
+
+        switch (n.kind) {
+            case RKind::LITERAL:
+            case RKind::EPS: {
+                out.start = newState();
+                out.end   = newState();
+                A.addTransition(out.start, n.kind == RKind::EPS ? '#' : n.literal, out.end);
+                break;
+            }
+
+            case RKind::EMPTYSET:
+                out.start = newState();
+                out.end   = newState();
+                break;
+
+            case RKind::CONCAT: {
+                if (frags.size() == f.base) {           // empty product = ε
+                    out.start = newState();
+                    out.end   = newState();
+                    addEpsilonTransition(A, out.start, out.end);
+                    break;
+                }
+                out = { frags[f.base].start, frags.back().end };
+                for (size_t i = f.base + 1; i < frags.size(); i++)
+                    addEpsilonTransition(A, frags[i - 1].end, frags[i].start);
+                break;
+            }
+
+            case RKind::UNION: {
+                out.start = newState();
+                out.end   = newState();
+                for (size_t i = f.base; i < frags.size(); i++) {
+                    addEpsilonTransition(A, out.start, frags[i].start);
+                    addEpsilonTransition(A, frags[i].end, out.end);
+                }
+                break;
+            }
+
+            case RKind::STAR: {
+                ENFAFragment c = frags.back();
+                out.start = newState();
+                out.end   = newState();
+                addEpsilonTransition(A, out.start, c.start);
+                addEpsilonTransition(A, c.end, out.end);
+                addEpsilonTransition(A, out.start, out.end);
+                addEpsilonTransition(A, c.end, c.start);
+                break;
+            }
+        }
+
+        frags.resize(f.base);
+        frags.push_back(out);
+        frames.pop_back();
+    }
 
+    A.addInitialState(frags.back().start);
+    A.addFinalState(frags.back().end);
     return A;
 }
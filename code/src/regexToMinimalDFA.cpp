@@ -6,13 +6,13 @@
 using namespace std;
 
 // Forward declaration (implemented elsewhere)
-void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName);
+Automaton minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName);
 
 /**
  * @brief Converts a regular expression into a **minimal DFA** using the full
  *        classical pipeline:
  *
- *          Regex → ε-NFA → NFA → DFA → Minimal DFA
+ *          Regex → ε-NFA → DFA → Minimal DFA
  *
  * @details
  * This function performs the following stages:
@@ -25,20 +25,16 @@ void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseNam
  *      This uses **Thompson’s construction**, which always produces an
  *      equivalent ε-NFA.
  *
- *   3. Convert the ε-NFA → NFA using:
- *          eNFAtoNFA()
- *      This removes epsilon transitions by computing ε-closures.
- *
- *   4. Convert the NFA → minimal DFA using:
+ *   3. Convert the ε-NFA → minimal DFA using:
  *          minimalDFA()
  *      This applies:
- *         - Subset construction (determinisation)
+ *         - Subset construction (determinisation), which follows the
+ *           ε-transitions itself: no separate ε-removal pass
  *         - DFA minimization
  *
  *   -----------------------------------------------------------------------
  *   Expected I/O Files Created:
  *     - ENFA written to outputs/enfa_<name>.txt
- *     - NFA  written to outputs/nfa_<name>.txt
  *     - Minimal DFA written to outputs/min_<name>.txt
  *     - DOT + image visualizations also generated for each stage.
  *
@@ -66,13 +62,8 @@ void regexToMinimalDFA() {
     Automaton enfa = regexToENFA(regexBaseName);
 
     // -------------------------------------------------------------
-    // Step 3: Convert εNFA → NFA (remove epsilon transitions).
-    // -------------------------------------------------------------
-    Automaton nfa = eNFAtoNFA(regexBaseName);
-
-    // -------------------------------------------------------------
-    // Step 4: Convert NFA → minimal DFA.
-    //         (Determinise + minimize internally.)
+    // Step 3: Convert εNFA → minimal DFA.
+    //         (Determinise, following ε-transitions, + minimize.)
     // -------------------------------------------------------------
-    minimalDFA(nfa, regexBaseName);
+    minimalDFA(enfa, regexBaseName);
 }
@@ -3,20 +3,45 @@
 #include "../include/RegexParser.h"
 #include "../include/RegexNormalize.h"
 #include "../include/RegexAST.h"
+#include "../include/RegexArena.h"
+#include "../include/RegexNFA.h"
+#include "../include/RegexDerivatives.h"
+#include "../include/RegexENFA.h"
 
-#include <fstream>
 #include <string>
 #include <memory>
 
 /*
- * External functions used in the regex → automaton pipeline.
- * These operate on filenames (not raw strings), so temporary
- * files are used to integrate them into the minimization process.
+ * External function used at the end of the pipeline.
  */
-extern Automaton regexToENFA(const std::string& inputBaseName);
-extern Automaton eNFAtoNFA(const std::string& inputBaseName);
 extern std::string automatonToRegex(const Automaton& A);
 
+/*
+ * regexToAutomaton(ast, construction)
+ *
+ * Dispatches to the chosen construction. Everything happens in memory;
+ * the Thompson ε-NFA is returned as is, for determinise() to close.
+ */
+Automaton regexToAutomaton(const std::shared_ptr<Regex> &ast,
+                           RegexConstruction construction) {
+    switch (construction) {
+
+        case RegexConstruction::Thompson:
+            return regexToENFA(ast ? *ast : *Regex::makeEmpty());
+
+        case RegexConstruction::Antimirov:
+            return regexToAntimirov(ast);
+
+        case RegexConstruction::Derivatives:
+            return regexToDerivativeDFA(ast);
+
+        case RegexConstruction::Glushkov:
+            break;
+    }
+
+    return regexToGlushkov(ast);
+}
+
 /*
  * astToString(r)
  *
@@ -29,61 +54,54 @@ static std::string astToString(std::shared_ptr<Regex> r) {
 }
 
 /*
- * minimizeRegex(regexInput)
+ * minimizeRegex(regexInput, construction)
  *
  * Performs full regular-expression minimization using:
  *
  *   1. Parse regex into AST
  *   2. AST-level simplification and normalization
- *   3. Write normalized regex to a temporary file
- *   4. Convert regex → ENFA
- *   5. Convert ENFA → NFA
- *   6. Determinise (NFA → DFA)
- *   7. Minimize the DFA
- *   8. Convert minimal DFA → regex (state elimination)
- *   9. AST-normalize final regex for canonical form
+ *   3. Convert AST → automaton (Glushkov NFA by default)
+ *   4. Determinise (NFA → DFA)
+ *   5. Minimize the DFA
+ *   6. Convert minimal DFA → regex (state elimination)
+ *   7. AST-normalize final regex for canonical form
  *
  * Returns the final simplified string form. Empty language is
  * returned as "", and epsilon as "#", matching project conventions.
  */
-std::string minimizeRegex(const std::string &regexInput) {
+std::string minimizeRegex(const std::string &regexInput,
+                          RegexConstruction construction) {
+
+    /* All AST nodes of this call live in one arena; only strings leave. */
+    RegexArena arena;
 
     /* Step 1: Parse and normalise AST of input regex */
     auto ast = parseRegexToAST(regexInput);
     ast = prettifyRegexAST(ast);
 
     /*
-     * Step 2: Write the normalized AST to a temporary input file,
-     * because regexToENFA() expects filename-based input.
-     */
-    std::string tmpBase = "tmp_min_regex_input";
-    std::string inputPath = std::string("../../inputs/") + tmpBase + ".txt";
-
-    {
-        std::ofstream fout(inputPath);
-        fout << ast->toString();
-        fout.close();
-    }
-
-    /*
-     * Step 3: Regex → ENFA → NFA
+     * Step 2: Regex AST → NFA
+     *
+     * The Glushkov automaton (the default) has one state per literal plus
+     * one and no ε-transitions, so no ε-removal and no temporary files are
+     * needed.  Determinisation numbers states in BFS order and minimize()
+     * keeps that order, so the minimal DFA does not depend on the choice.
      */
-    Automaton enfa = regexToENFA(tmpBase);
-    Automaton nfa  = eNFAtoNFA(tmpBase);
+    Automaton nfa = regexToAutomaton(ast, construction);
 
     /*
-     * Step 4: Determinise and minimize the automaton
+     * Step 3: Determinise and minimize the automaton
      */
     Automaton dfa    = Automaton::determinise(nfa);
     Automaton minDFA = Automaton::minimize(dfa);
 
     /*
-     * Step 5: Convert minimal DFA back to a regex
+     * Step 4: Convert minimal DFA back to a regex
      */
     std::string rawRegex = automatonToRegex(minDFA);
 
     /*
-     * Step 6: Final round of AST parsing and prettification
+     * Step 5: Final round of AST parsing and prettification
      */
     auto outAst = parseRegexToAST(rawRegex);
     outAst = prettifyRegexAST(outAst);
@@ -91,7 +109,7 @@ std::string minimizeRegex(const std::string &regexInput) {
     std::string finalStr = outAst->toString();
 
     /*
-     * Step 7: Special-case returns
+     * Step 6: Special-case returns
      */
     if (finalStr.empty()) return "";   // empty language
     if (finalStr == "#")   return "#"; // epsilon
@@ -0,0 +1,106 @@
+#include "../include/RenderQueue.h"
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+extern char** environ;
+
+using namespace std;
+
+RenderQueue::RenderQueue(unsigned maxProcesses) : pool(maxProcesses) {}
+
+void RenderQueue::submit(const string& dotFile, const string& imageFile) {
+    uint64_t generation;
+    {
+        lock_guard<mutex> guard(imagesLock);
+        generation = ++images[imageFile].submitted;
+    }
+    pool.submit([this, dotFile, imageFile, generation] { render(dotFile, imageFile, generation); });
+}
+
+void RenderQueue::waitAll() {
+    pool.waitAll();
+}
+
+RenderQueue& RenderQueue::shared() {
+    static RenderQueue queue;
+    return queue;
+}
+
+string RenderQueue::stagingPath(const string& path) {
+    static atomic<uint64_t> counter(0);
+    return path + ".tmp." + to_string(getpid()) + "." + to_string(++counter);
+}
+
+bool RenderQueue::commitFile(const string& stagingFile, const string& path) {
+    error_code ec;
+    filesystem::rename(stagingFile, path, ec);
+    if (!ec) return true;
+
+    filesystem::remove(stagingFile, ec);
+    return false;
+}
+
+/**
+ * @brief Runs `dot -Tpng dotFile -o <staging>` and waits for it to exit,
+ *        then moves the image into place unless a newer render of it has
+ *        already been written.
+ *
+ * @details
+ * The worker only sleeps in waitpid() while Graphviz does the layout, so
+ * the pool size is the number of concurrent dot processes.  Failures are
+ * counted and reported on stderr, one whole line per job.
+ */
+void RenderQueue::render(const string& dotFile, const string& imageFile, uint64_t generation) {
+    error_code ec;
+    filesystem::path directory = filesystem::path(imageFile).parent_path();
+    if (!directory.empty()) filesystem::create_directories(directory, ec);
+
+    string stagingFile = stagingPath(imageFile);
+    vector<string> args = { "dot", "-Tpng", dotFile, "-o", stagingFile };
+    vector<char*> argv;
+    for (string& arg : args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    int error = posix_spawnp(&pid, "dot", nullptr, nullptr, argv.data(), environ);
+    if (error != 0) {
+        failed++;
+        cerr << ("[ERROR] RenderQueue: cannot run dot for " + dotFile + ": " + strerror(error) + "\n");
+        return;
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            status = -1;
+            break;
+        }
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        failed++;
+        filesystem::remove(stagingFile, ec);
+        cerr << ("[ERROR] RenderQueue: dot failed on " + dotFile + "\n");
+        return;
+    }
+
+    lock_guard<mutex> guard(imagesLock);
+    ImageState& image = images[imageFile];
+
+    if (generation < image.published) {
+        filesystem::remove(stagingFile, ec);       // superseded
+    } else if (commitFile(stagingFile, imageFile)) {
+        image.published = generation;
+    } else {
+        failed++;
+        cerr << ("[ERROR] RenderQueue: cannot write " + imageFile + "\n");
+    }
+}
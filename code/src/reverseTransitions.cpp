@@ -1,4 +1,5 @@
 #include "../include/Automaton.h"
+#include "../include/CSRAutomaton.h"
 
 /**
  * @brief Computes the **reverse (transpose) automaton** Aᵗ of a given automaton A.
@@ -25,40 +26,30 @@
  *   - Brzozowski’s DFA minimization method (reverse → determinise → reverse → determinise).
  *   - Language reversal: L(Aᵗ) = L(A)ʳ (the reverse of the language).
  *
+ * The reversal itself is done on the frozen CSR form of A with two
+ * counting-sort passes (see CSRAutomaton::reverse()), so no per-transition
+ * map lookups or set inserts are needed.
+ *
  * @param A  The input automaton A whose transitions are to be reversed.
  *
  * @return The reversed automaton Aᵗ.
  */
 Automaton Automaton::reverseTransitions(const Automaton& A) {
-    Automaton R;
 
     // --------------------------------------------------------------
-    // Step 1: Copy state set and alphabet directly (unchanged).
+    // Step 1: Freeze A (cached), then transpose its CSR arrays:
+    //         states and alphabet are kept, I and F are swapped, and
+    //         every transition (from --symbol--> to) becomes
+    //         (to --symbol--> from).
     // --------------------------------------------------------------
-    R.states   = A.states;
-    R.alphabet = A.alphabet;
+    CSRAutomaton R = A.freeze().reverse();
 
     // --------------------------------------------------------------
-    // Step 2: Swap initial and final states.
-    //         This follows the formal definition of Aᵗ.
-    // --------------------------------------------------------------
-    R.initialStates = A.finalStates;
-    R.finalStates   = A.initialStates;
-
+    // Step 2: Back to the map-based representation.  R already is the
+    //         frozen form of the result, so keep it as its cache.
     // --------------------------------------------------------------
-    // Step 3: Reverse the direction of every transition.
-    //
-    //         For each transition (from --symbol--> to), add the
-    //         reversed transition (to --symbol--> from).
-    // --------------------------------------------------------------
-    for (auto& [key, value] : A.transitions) {
-        int from    = key.first;
-        char symbol = key.second;
-
-        for (int to : value) {
-            R.transitions[{to, symbol}].insert(from);
-        }
-    }
+    Automaton At = R.toAutomaton();
+    At.frozen = std::make_shared<const CSRAutomaton>(std::move(R));
 
-    return R;
+    return At;
 }
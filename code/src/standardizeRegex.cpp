@@ -1,6 +1,8 @@
 #include "../include/Automaton.h"
 #include "../include/RegexENFA.h"
 #include "../include/NFAToRegex.h"
+#include "../include/RegexParser.h"
+#include "../include/RegexUtils.h"
 
 #include <fstream>
 #include <iostream>
@@ -9,9 +11,8 @@
 
 using namespace std;
 
-// Forward declarations (defined elsewhere)
-Automaton eNFAtoNFA(const string& inputBaseName);
-void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName);
+// Forward declaration (defined elsewhere)
+Automaton minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseName);
 
 /**
  * @brief Produces a **standardized (canonical) regular expression** for a given regex.
@@ -24,10 +25,15 @@ void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseNam
  *       Uses Thompson’s construction (regexToENFA).  
  *       Produces an ε-NFA that accepts exactly the language of the regex.
  *
- *   (2) ε-NFA → NFA  
- *       Removes ε-transitions via epsilon-closure.
+ *   (2) ε-transitions are not removed in a pass of their own:
+ *       determinisation follows them while building subsets, so the
+ *       ε-NFA goes through one subset construction only.
  *
- *   (3) NFA → Minimal DFA  
+ *       With any other construction, (1) and (2) are replaced by building
+ *       an ε-free automaton straight from the parsed regex
+ *       (regexToAutomaton); no enfa_ file is written then.
+ *
+ *   (3) (ε-)NFA → Minimal DFA  
  *       Uses determinisation + DFA minimization.
  *       The minimal DFA is unique up to isomorphism.
  *
@@ -51,11 +57,14 @@ void minimalDFA(Automaton& nonDeterministicAutomaton, const string& inputBaseNam
  *      The standardized regex is written to:
  *          "../../outputs/std_regex_<name>.txt"
  *
+ * @param construction Regex → automaton construction (Thompson by default).
+ *
  * @note
  * - The regex file must contain a single-line regular expression.
- * - This function performs multiple read/write cycles to verify correctness.
+ * - The standardized regex file is read back to verify it; intermediate
+ *   automata are written only as far as the artifact policy allows.
  */
-void standardizeRegex() {
+void standardizeRegex(RegexConstruction construction) {
     string regexBaseName;
 
     // --------------------------------------------------------------
@@ -64,37 +73,46 @@ void standardizeRegex() {
     cout << "\nEnter the regex file name (without .txt): ";
     cin >> regexBaseName;
 
-    // --------------------------------------------------------------
-    // Step 1: Regex → ε-NFA
-    // --------------------------------------------------------------
-    cout << "Step 1: Converting Regex to eNFA..." << endl;
-    Automaton enfa = regexToENFA(regexBaseName);
+    Automaton nfa;
 
-    // --------------------------------------------------------------
-    // Step 2: ε-NFA → NFA (remove epsilon transitions)
-    // --------------------------------------------------------------
-    cout << "Step 2: Converting eNFA to NFA..." << endl;
-    Automaton nfa = eNFAtoNFA(regexBaseName);
+    if (construction == RegexConstruction::Thompson) {
+        // ----------------------------------------------------------
+        // Step 1: Regex → ε-NFA
+        // ----------------------------------------------------------
+        cout << "Step 1: Converting Regex to eNFA..." << endl;
+        nfa = regexToENFA(regexBaseName);
+
+        // ----------------------------------------------------------
+        // Step 2: ε-transitions are handled by determinisation (Step 3)
+        // ----------------------------------------------------------
+    }
+    else {
+        // ----------------------------------------------------------
+        // Step 1 & 2: Regex → ε-free automaton, in memory
+        // ----------------------------------------------------------
+        string inputPath = "../../inputs/" + regexBaseName + ".txt";
+        ifstream fin(inputPath);
+        if (!fin.is_open()) {
+            cout << "Error: Could not read file " << inputPath << endl;
+            return;
+        }
+
+        string regex;
+        getline(fin, regex);
+        fin.close();
+
+        cout << "Step 1 & 2: Building automaton from Regex..." << endl;
+        nfa = regexToAutomaton(parseRegexToAST(regex), construction);
+    }
 
     // --------------------------------------------------------------
     // Step 3: Determinisation + Minimization
     //         Produces the minimal DFA, which is canonical.
     // --------------------------------------------------------------
     cout << "Step 3 & 4: Determinising, Minimizing, and generating image..." << endl;
-    minimalDFA(nfa, regexBaseName);
-
-    // --------------------------------------------------------------
-    // Step 4 (continued): Read back the minimal DFA for conversion
-    // --------------------------------------------------------------
-    string minDFA_path = "../../outputs/min_" + regexBaseName + ".txt";
-    cout << "Reading back minimal DFA from " << minDFA_path << "..." << endl;
-
-    Automaton minDFA = Automaton::readAutomaton(minDFA_path);
-
-    if (minDFA.getStates().empty()) {
-        cout << "Error: Could not read back minimal DFA from " << minDFA_path << endl;
-        return;
-    }
+    // The minimal DFA is used as returned: its text file under
+    // ../../outputs/ exists only if the artifact policy writes one.
+    Automaton minDFA = minimalDFA(nfa, regexBaseName);
 
     // --------------------------------------------------------------
     // Step 5: Minimal DFA → Standardized regex
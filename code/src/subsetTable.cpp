@@ -0,0 +1,79 @@
+#include "../include/SubsetTable.h"
+
+#include <algorithm>
+
+using namespace std;
+
+SubsetTable::SubsetTable(uint32_t universe)
+    : wordsPerSet((universe + 63) / 64),
+      slots(16, NONE) {}
+
+/**
+ * @brief Linear probing from the home slot of h.
+ *
+ * Stops at the slot holding an equal subset (same fingerprint, then same
+ * words) or at the first empty slot.
+ */
+size_t SubsetTable::probe(const uint64_t* w, uint64_t h) const {
+    size_t mask = slots.size() - 1;
+    size_t i = (size_t)h & mask;
+
+    while (true) {
+        uint32_t id = slots[i];
+        if (id == NONE) return i;
+
+        if (fingerprints[id] == h &&
+            equal(w, w + wordsPerSet, arena.data() + (size_t)id * wordsPerSet)) {
+            return i;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+/**
+ * @brief Doubles the slot array and reinserts every id by its stored
+ *        fingerprint (no rehashing of subsets).
+ */
+void SubsetTable::grow() {
+    vector<uint32_t> bigger(slots.size() * 2, NONE);
+    size_t mask = bigger.size() - 1;
+
+    for (uint32_t id = 0; id < size(); id++) {
+        size_t i = (size_t)fingerprints[id] & mask;
+        while (bigger[i] != NONE) i = (i + 1) & mask;
+        bigger[i] = id;
+    }
+
+    slots.swap(bigger);
+}
+
+void SubsetTable::clear() {
+    arena.clear();
+    fingerprints.clear();
+    fill(slots.begin(), slots.end(), NONE);
+}
+
+uint32_t SubsetTable::find(const StateSet& S) const {
+    return slots[probe(S.data(), S.hash())];
+}
+
+uint32_t SubsetTable::intern(const StateSet& S, uint64_t h, bool& inserted) {
+    size_t i = probe(S.data(), h);
+
+    if (slots[i] != NONE) {
+        inserted = false;
+        return slots[i];
+    }
+
+    uint32_t id = size();
+    arena.insert(arena.end(), S.data(), S.data() + wordsPerSet);
+    fingerprints.push_back(h);
+    slots[i] = id;
+    inserted = true;
+
+    // Keep the load factor at or below 1/2.
+    if ((size_t)size() * 2 > slots.size()) grow();
+
+    return id;
+}
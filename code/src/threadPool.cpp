@@ -0,0 +1,89 @@
+#include "../include/ThreadPool.h"
+
+#include <atomic>
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if (numThreads == 0) numThreads = thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 1;
+
+    for (unsigned i = 0; i < numThreads; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+
+    for (thread& t : workers) t.join();
+}
+
+void ThreadPool::submit(function<void()> task) {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void ThreadPool::waitAll() {
+    unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return tasks.empty() && running == 0; });
+}
+
+/**
+ * @brief Worker body: pop a task, run it, repeat until the pool stops
+ *        and the queue has drained.
+ */
+void ThreadPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+            if (tasks.empty()) return;     // stopping and drained
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            running++;
+        }
+
+        task();
+
+        {
+            lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (tasks.empty() && running == 0) allDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, size_t grain,
+                             const function<void(size_t, size_t, unsigned)>& body) {
+    if (grain == 0) grain = 1;
+
+    if (n <= grain || size() == 1) {
+        if (n > 0) body(0, n, 0);
+        return;
+    }
+
+    atomic<size_t> nextChunk(0);
+
+    for (unsigned w = 0; w < size(); w++) {
+        submit([&, w] {
+            while (true) {
+                size_t begin = nextChunk.fetch_add(grain);
+                if (begin >= n) break;
+                body(begin, min(n, begin + grain), w);
+            }
+        });
+    }
+
+    waitAll();
+}
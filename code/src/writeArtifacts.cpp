@@ -0,0 +1,55 @@
+#include "../include/Dot.h"
+
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+atomic<ArtifactPolicy> policy(ArtifactPolicy::Png);
+
+} // namespace
+
+void Dot::setArtifactPolicy(ArtifactPolicy p) {
+    policy.store(p);
+}
+
+ArtifactPolicy Dot::artifactPolicy() {
+    return policy.load();
+}
+
+bool Dot::parseArtifactPolicy(const string& name, ArtifactPolicy& p) {
+    if      (name == "none") p = ArtifactPolicy::None;
+    else if (name == "text") p = ArtifactPolicy::Text;
+    else if (name == "dot")  p = ArtifactPolicy::Dot;
+    else if (name == "png")  p = ArtifactPolicy::Png;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief Writes the text file, DOT graph and PNG image of one pipeline
+ *        stage, stopping at the level set by the artifact policy.
+ *
+ * @details
+ * The DOT graph is built from A itself, so the text file is never read
+ * back; with ArtifactPolicy::None the stage writes nothing at all.
+ */
+void Dot::writeArtifacts(const Automaton& A,
+                         const string& textFile,
+                         const string& dotFile,
+                         const string& graphName,
+                         const string& prefix,
+                         const string& filename) {
+    ArtifactPolicy level = artifactPolicy();
+
+    if (level == ArtifactPolicy::None) return;
+    if (!textFile.empty()) A.writeAutomaton(textFile);
+
+    if (level == ArtifactPolicy::Text) return;
+    generateDot(A, dotFile, graphName);
+
+    if (level == ArtifactPolicy::Dot) return;
+    generateImage(dotFile, prefix, filename);
+}
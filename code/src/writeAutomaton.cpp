@@ -1,6 +1,8 @@
 #include "../include/Automaton.h"
 
+#include <charconv>
 #include <fstream>
+#include <ostream>
 
 /**
  * @brief Writes the automaton to a text file in a standardized, readable format.
@@ -39,9 +41,77 @@
  *  - Maintaining compatibility with Dot generator modules
  *
  * @param filename  Output file path (e.g., "../../outputs/min_A.txt")
+ * @return False if the file could not be opened, written or closed.
  */
-void Automaton::writeAutomaton(const std::string &filename) const {
+bool Automaton::writeAutomaton(const std::string &filename) const {
     std::ofstream fout(filename);
+    if (!fout.is_open()) return false;
+
+    writeAutomaton(fout);
+    fout.close();
+    return !fout.fail();
+}
+
+namespace {
+
+/**
+ * @brief Output buffer formatted with to_chars and handed to the stream in
+ *        large blocks.
+ */
+class TextBuffer {
+public:
+    explicit TextBuffer(std::ostream& out) : out(out) {
+        buffer.reserve(FLUSH_AT + 64);
+    }
+
+    ~TextBuffer() {
+        flush();
+    }
+
+    TextBuffer& operator<<(const char* s) {
+        buffer += s;
+        return spill();
+    }
+
+    TextBuffer& operator<<(char c) {
+        buffer += c;
+        return spill();
+    }
+
+    TextBuffer& operator<<(int v) {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof digits, v);
+        buffer.append(digits, result.ptr);
+        return spill();
+    }
+
+    void flush() {
+        out.write(buffer.data(), (std::streamsize)buffer.size());
+        buffer.clear();
+    }
+
+private:
+    static constexpr size_t FLUSH_AT = 1 << 20;
+
+    std::ostream& out;
+    std::string buffer;
+
+    TextBuffer& spill() {
+        if (buffer.size() >= FLUSH_AT) flush();
+        return *this;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Writes the format of writeAutomaton(filename) to any output stream.
+ *
+ * Formats into a 1 MB buffer (TextBuffer) rather than through the stream's
+ * operator<<, one block write per megabyte of text.
+ */
+void Automaton::writeAutomaton(std::ostream &stream) const {
+    TextBuffer fout(stream);
 
     // --------------------------------------------------------------
     // STATES
@@ -90,6 +160,4 @@ void Automaton::writeAutomaton(const std::string &filename) const {
         fout << s << " ";
     }
     fout << "\n";
-
-    fout.close();
 }